@@ -0,0 +1,156 @@
+/* autoplay.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The autoplay.c module is a bot that plays Tetris through game_update's API -- it uses the game's
+* own collision checks (game_update_piece_fits) and background updates to try out placements, so it
+* always agrees with the real game about what fits. Used for soak tests and load generation.
+*/
+
+#include "autoplay.h"
+#include <stddef.h>
+#include "strings.h"
+#include "timer.h"
+
+// Candidates: (swap * 4 + rotation) * (ncols + 3) + (x + 3) -- a piece's 4x4 grid can hang up to
+// 3 columns off the left edge
+static int columns(const game_t* game) {
+    return game->ncols + 3;
+}
+
+int autoplay_num_candidates(const game_t* game) {
+    return 2 * 4 * columns(game);
+}
+
+// Helper to clear the filled rows of a scratch board (compacting the others down); returns lines cleared
+static int clearScratchRows(game_t* board) {
+    int lines = 0;
+    for (int row = 0; row < board->nrows; row++) {
+        if (board->rowFill[board->rowIndex[row]] == board->ncols) {
+            game_update_remove_row(board, row);
+            lines++;
+        }
+    }
+    return lines;
+}
+
+// Helper to score a board after a piece has been dropped into it (higher is better)
+static long scoreBoard(game_t* board) {
+    int lines = clearScratchRows(board);
+    long height = 0, holes = 0, bumpiness = 0;
+    int prevHeight = 0;
+    for (int col = 0; col < board->ncols; col++) {
+        int colHeight = 0;
+        for (int row = 0; row < board->nrows; row++) {
+            if (game_update_get_cell(board, col, row) != BOARD_CELL_EMPTY) {
+                if (colHeight == 0) colHeight = board->nrows - row;
+            } else if (colHeight != 0) {
+                holes++;
+            }
+        }
+        height += colHeight;
+        if (col > 0) bumpiness += (colHeight > prevHeight) ? colHeight - prevHeight : prevHeight - colHeight;
+        prevHeight = colHeight;
+    }
+    return AUTOPLAY_WEIGHT_HEIGHT * height + AUTOPLAY_WEIGHT_LINES * lines
+         + AUTOPLAY_WEIGHT_HOLES * holes + AUTOPLAY_WEIGHT_BUMPY * bumpiness;
+}
+
+// Walks piece to the candidate's placement the way the game would move it: swap, rotate, slide, drop.
+// Every step has to fit, just like in the game
+bool autoplay_evaluate(game_t* game, const falling_piece_t* piece, bool allow_swap, int candidate,
+                       autoplay_scratch_t* scratch, autoplay_move_t* move) {
+    int x = candidate % columns(game) - 3;
+    int rotation = (candidate / columns(game)) % 4;
+    bool swapping = candidate / (4 * columns(game));
+    if (swapping && !allow_swap) return false;
+
+    falling_piece_t p = *piece;
+    if (swapping) {
+        p.pieceT = game->nextFallingPiece;
+        if (!game_update_piece_fits(game, &p)) return false;
+    }
+    // rotations that look the same as one that takes fewer turns are duplicates (all of the o piece's)
+    int turns = (rotation - p.rotation + 4) % 4;
+    for (int t = 0; t < turns; t++) {
+        if (p.pieceT.block_rotations[(p.rotation + t) % 4] == p.pieceT.block_rotations[rotation]) return false;
+    }
+    for (int t = 0; t < turns; t++) {
+        p.rotation = (p.rotation + 1) % 4;
+        if (!game_update_piece_fits(game, &p)) return false;
+    }
+    while (p.x != x) {
+        p.x += (x < p.x) ? -1 : 1;
+        if (!game_update_piece_fits(game, &p)) return false;
+    }
+    do {
+        p.y++;
+    } while (game_update_piece_fits(game, &p));
+    p.y--;
+
+    // copy the game up to the end of the rows in use (the board is the game_t's last member)
+    memcpy(&scratch->board, game, offsetof(game_t, background_tracker) + game->nrows * sizeof(board_row_t));
+    scratch->board.recorder = NULL;
+    iterateThroughPieceSquares(&scratch->board, &p, update_background);
+
+    move->swap = swapping;
+    move->rotation = rotation;
+    move->x = x;
+    move->y = p.y;
+    move->candidate = candidate;
+    move->value = scoreBoard(&scratch->board);
+    return true;
+}
+
+void autoplay_keep_best(autoplay_move_t* best, const autoplay_move_t* move) {
+    if (move->candidate < 0) return;
+    if (best->candidate < 0 || move->value > best->value
+        || (move->value == best->value && move->candidate < best->candidate)) {
+        *best = *move;
+    }
+}
+
+void autoplay_search_begin(autoplay_search_t* search, game_t* game, const falling_piece_t* piece, bool allow_swap) {
+    search->game = game;
+    search->piece = *piece;
+    search->allow_swap = allow_swap;
+    search->next = 0;
+    search->ncandidates = autoplay_num_candidates(game);
+    search->best.candidate = -1;    // if nothing is reachable, just drop the piece where it is
+    search->best.swap = false;
+    search->best.rotation = piece->rotation;
+    search->best.x = piece->x;
+    search->best.y = piece->y;
+}
+
+bool autoplay_search_next(autoplay_search_t* search) {
+    if (search->next < search->ncandidates) {
+        autoplay_move_t move;
+        if (autoplay_evaluate(search->game, &search->piece, search->allow_swap, search->next, &search->scratch, &move)) {
+            autoplay_keep_best(&search->best, &move);
+        }
+        search->next++;
+    }
+    return search->next == search->ncandidates;
+}
+
+bool autoplay_search_step(autoplay_search_t* search, int budget_us) {
+    unsigned long start = timer_get_ticks();
+    while (!autoplay_search_next(search)) {
+        if (timer_get_ticks() - start >= (unsigned long)budget_us * TICKS_PER_USEC) return false;
+    }
+    return true;
+}
+
+game_cmd_t autoplay_next_command(game_t* game, autoplay_move_t* move, const falling_piece_t* piece) {
+    if (move->swap) {
+        move->swap = false;
+        return GAME_CMD_SWAP;
+    }
+    if (piece->rotation != move->rotation) return GAME_CMD_ROTATE;
+    if (piece->x > move->x) return GAME_CMD_LEFT;
+    if (piece->x < move->x) return GAME_CMD_RIGHT;
+    falling_piece_t below = *piece;
+    below.y++;
+    return game_update_piece_fits(game, &below) ? GAME_CMD_DOWN : GAME_CMD_LOCK;
+}
@@ -0,0 +1,69 @@
+#ifndef _AUTOPLAY_H
+#define _AUTOPLAY_H
+
+#include <stdbool.h>
+#include "game_update.h"
+
+// Autoplayer: tries every reachable placement (rotation x column) of the falling piece, and of the
+// next piece via swap, and picks the one whose resulting board scores best on a heuristic.
+// Placements are reached the way a player would: swap, rotate, slide sideways, then drop.
+//
+// Candidates are numbered 0 .. autoplay_num_candidates()-1 and can be evaluated in any order or on
+// any thread (evaluation only reads the game), each evaluator with its own autoplay_scratch_t.
+// autoplay_search_t evaluates them a slice at a time, so the Mango Pi can stay within a frame budget.
+
+// Heuristic weights (x1000; boards are scored in integers, the Mango Pi has no floating point)
+#define AUTOPLAY_WEIGHT_HEIGHT  -510   // per square of aggregate column height
+#define AUTOPLAY_WEIGHT_LINES    760   // per line cleared
+#define AUTOPLAY_WEIGHT_HOLES   -357   // per empty square with a filled square somewhere above it
+#define AUTOPLAY_WEIGHT_BUMPY   -184   // per square of height difference between neighbouring columns
+
+typedef struct {
+    bool swap;          // swap with the next piece first
+    int rotation;       // rotation to end up in (0-3)
+    int x;              // column to end up in
+    int y;              // row it lands in
+    int candidate;      // which candidate this is (-1: none found)
+    long value;         // heuristic score of the board after the drop (higher is better)
+} autoplay_move_t;
+
+typedef struct {
+    game_t board;                           // scratch copy of the game the candidate is dropped into
+} autoplay_scratch_t;
+
+// Incremental search for one piece
+typedef struct {
+    game_t* game;
+    falling_piece_t piece;      // piece as it was when the search began
+    bool allow_swap;
+    int next;                   // next candidate to evaluate
+    int ncandidates;
+    autoplay_move_t best;
+    autoplay_scratch_t scratch;
+} autoplay_search_t;
+
+int autoplay_num_candidates(const game_t* game);
+
+// Evaluates one candidate. Returns false if it can't be reached (or is a swap that's not allowed)
+bool autoplay_evaluate(game_t* game, const falling_piece_t* piece, bool allow_swap, int candidate,
+                       autoplay_scratch_t* scratch, autoplay_move_t* move);
+
+// Keeps the better of two moves in best (ties go to the lower candidate number, so the choice
+// doesn't depend on the order candidates were evaluated in)
+void autoplay_keep_best(autoplay_move_t* best, const autoplay_move_t* move);
+
+void autoplay_search_begin(autoplay_search_t* search, game_t* game, const falling_piece_t* piece, bool allow_swap);
+
+// Evaluates the next candidate; returns true once every candidate has been evaluated
+// (search->best is then the move to make)
+bool autoplay_search_next(autoplay_search_t* search);
+
+// Evaluates candidates until budget_us microseconds have passed (at least one candidate per call)
+// Returns true once every candidate has been evaluated
+bool autoplay_search_step(autoplay_search_t* search, int budget_us);
+
+// Next command to move piece towards move (GAME_CMD_LOCK once it's resting in place).
+// Clears move->swap once the swap has been issued
+game_cmd_t autoplay_next_command(game_t* game, autoplay_move_t* move, const falling_piece_t* piece);
+
+#endif
@@ -0,0 +1,38 @@
+/* cycle_count.h
+ * Reads the cpu cycle counter, for measuring how long short pieces of code take
+ * (the timer module's ticks are 24MHz, too coarse for timing a single interrupt handler)
+ * On the host build (make host) it reads the host's nanosecond clock instead: at the D1's 1GHz,
+ * one cycle is one nanosecond, so cycle budgets mean the same amount of time on both
+ * Author: Aditi (aditijb@stanford.edu)
+ */
+
+#ifndef CYCLE_COUNT_H
+#define CYCLE_COUNT_H
+
+/* 'cycle_count_read'
+ * @return - number of cpu cycles since reset (mcycle csr). the D1 runs at 1GHz, so 1000 cycles = 1us
+ * (a RISC-V Linux program -- host/kernels-rv under qemu -- runs in user mode, where only the
+ * rdcycle alias of the counter is readable)
+ */
+#if defined(__riscv) && !defined(__linux__)
+static inline unsigned long cycle_count_read(void) {
+    unsigned long cycles ;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(cycles)) ;
+    return cycles ;
+}
+#elif defined(__riscv)
+static inline unsigned long cycle_count_read(void) {
+    unsigned long cycles ;
+    __asm__ volatile ("rdcycle %0" : "=r"(cycles)) ;
+    return cycles ;
+}
+#else
+#include <time.h>
+static inline unsigned long cycle_count_read(void) {
+    struct timespec ts ;
+    clock_gettime(CLOCK_MONOTONIC, &ts) ;
+    return ts.tv_sec * 1000000000UL + ts.tv_nsec ;
+}
+#endif
+
+#endif
@@ -3,54 +3,172 @@
  * Author: Aditi (aditijb@stanford.edu)
  * 
  * user abilities:
- *    - store and show leaderboard 
+ *    - store and show leaderboard (saved in the leaderboard log, leaderboard_log.h, so it outlasts a game)
  *    - to add yourself to leaderboard, select 2-letter initials (using button presses)
  *    - play game again
  */
 
-#include "console.h"
 #include "game_interlude.h"
-#include "malloc.h"
+#include "render.h"
+#include "strings.h"
 #include "remote.h"
 #include "LSD6DS33.h"
 #include "timer.h"
 #include "printf.h"
+#include <stdarg.h>
+#include "passive_buzz_intr.h"
+#include "song_assets.h"
+#include "leaderboard.h"
+#include "leaderboard_log.h"
 
 static interlude_contents_t contents ;
+static song_t interlude_song ; // calmer song played on the leaderboard screens
+static leaderboard_t board ; // the all-time leaderboard
+static leaderboard_log_t leaderboard_log ; // every score saved to the leaderboard, on storage
 #define BLINK_DELAY 100 
+#define TAB_WIDTH 4 // '\t' moves to the next multiple of this column
 
 #define FRANCIS_DEMO 1 // if this == 1, then francis goes to the top of the score chart :)
+#define TICKS_PER_SEC 24000000 // timer_get_ticks() counts 24 ticks per microsecond
+
+/* text screen
+ * the interlude's console: a grid of characters drawn (with render.h) from the top left corner of the
+ * screen that's up. like libmango's console, every clear/printf shows it -- but only the character
+ * cells that changed since the last time are drawn. _shown is what both screen buffers hold, so a
+ * change is drawn, shown, then drawn again into the other buffer
+ */
+
+// draws the cells of row that differ from _shown (runs of them, copied from the glyph atlas)
+static void interlude_text_draw_changes(int row) {
+    int char_width = gl_get_char_width() ; int char_height = gl_get_char_height() ;
+    char run[INTERLUDE_MAX_COLS + 1] ;
+    for (int col = 0; col < contents._ncols; ) {
+        if (contents._shown_valid && contents._text[row][col] == contents._shown[row][col]) { col++ ; continue ; }
+        int start = col ;
+        while (col < contents._ncols && (!contents._shown_valid || contents._text[row][col] != contents._shown[row][col])) col++ ;
+        memcpy(run, &contents._text[row][start], col - start) ;
+        run[col - start] = '\0' ;
+        render_text_blit(start * char_width, row * char_height, run, contents._fg, contents._bg) ;
+    }
+}
+
+// shows the text screen, drawing only what changed (everything, the first time after something else
+// was on the screen)
+static void interlude_text_show(void) {
+    int rows = contents._nrows ;
+    while (rows > 0 && (rows - 1) * gl_get_char_height() >= gl_get_height()) rows-- ;   // (cut off at the bottom)
+    for (int row = 0; row < rows; row++) interlude_text_draw_changes(row) ;
+    render_show() ;
+    for (int row = 0; row < rows; row++) interlude_text_draw_changes(row) ;   // the other buffer
+    memcpy(contents._shown, contents._text, sizeof(contents._text)) ;
+    contents._shown_valid = true ;
+}
+
+// the screen has had something else on it: the next show draws every cell
+static void interlude_text_invalidate(void) {
+    contents._shown_valid = false ;
+}
+
+// replaces line row with str (padded with spaces; the cursor stays put). shown by the next show
+static void interlude_text_set_line(int row, const char *str) {
+    int col = 0 ;
+    for (; col < contents._ncols && str[col] != '\0'; col++) contents._text[row][col] = str[col] ;
+    memset(&contents._text[row][col], ' ', contents._ncols - col) ;
+}
+
+// blinks the character cell (row, col): off (ch_off) and on (ch_on) again, times times, delay_ms apart.
+// only that one cell is ever drawn
+static void interlude_text_blink(int row, int col, char ch_on, char ch_off, int times, int delay_ms) {
+    for (int i = 0; i < times; i++) {
+        timer_delay_ms(delay_ms) ;
+        contents._text[row][col] = ch_off ;
+        interlude_text_show() ;
+        timer_delay_ms(delay_ms) ;
+        contents._text[row][col] = ch_on ;
+        interlude_text_show() ;
+    }
+}
+
+// moves to the start of the next line, scrolling the text up a line at the bottom
+static void interlude_text_newline(void) {
+    contents._col = 0 ;
+    if (++contents._row < contents._nrows) return ;
+    for (int row = 1; row < contents._nrows; row++) memcpy(contents._text[row - 1], contents._text[row], contents._ncols) ;
+    memset(contents._text[contents._nrows - 1], ' ', contents._ncols) ;
+    contents._row = contents._nrows - 1 ;
+}
+
+// puts one character at the cursor ('\n', '\r', '\b', '\f' and '\t' as on the console)
+static void interlude_text_put(char ch) {
+    switch (ch) {
+        case '\n': interlude_text_newline() ; break ;
+        case '\r': contents._col = 0 ; break ;
+        case '\b': if (contents._col > 0) contents._col-- ; break ;
+        case '\f': memset(contents._text, ' ', sizeof(contents._text)) ; contents._row = contents._col = 0 ; break ;
+        case '\t': do interlude_text_put(' ') ; while (contents._col % TAB_WIDTH != 0) ; break ;
+        default:
+            if (contents._col == contents._ncols) interlude_text_newline() ;
+            contents._text[contents._row][contents._col++] = ch ;
+    }
+}
+
+// blanks the text screen (console_clear)
+static void interlude_text_clear(void) {
+    memset(contents._text, ' ', sizeof(contents._text)) ;
+    contents._row = contents._col = 0 ;
+    interlude_text_show() ;
+}
+
+// prints at the cursor (console_printf)
+static void interlude_text_printf(const char *format, ...) {
+    char buf[256] ;
+    va_list ap ;
+    va_start(ap, format) ;
+    vsnprintf(buf, sizeof(buf), format, ap) ;
+    va_end(ap) ;
+    for (const char *s = buf; *s != '\0'; s++) interlude_text_put(*s) ;
+    interlude_text_show() ;
+}
+
+// leaderboard_log_open callback: a saved score
+static void game_interlude_load_record(const leaderboard_record_t *record, void *arg) {
+    leaderboard_add(&board, record) ;
+}
 
 /* 'game_interlude_init'
  * initializes game screen to nrows and ncols wide, where every row/col size (in pixels) is determined by the character size
  * takes colors text and bg for the text and background colors respectively
+ * (sets up a screen only if none is up yet; otherwise the interlude shares the game's)
  */
 void game_interlude_init(int nrows, int ncols, color_t text, color_t bg) {
 
-    // console info
-    console_init(nrows, ncols, text, bg);
-    contents._ncols = ncols ;
-    contents._nrows = nrows ;
-    contents._leaderboard = malloc(LEADERBOARD_SIZE*sizeof(leaderboard_character_t)) ; // 3 chars per each leaderboard thing
-
-    for(int i = 0; i < LEADERBOARD_SIZE; i++) {
-        contents._leaderboard[i]._initials[0] = '*' ; 
-        contents._leaderboard[i]._initials[1] = '*' ; 
-        contents._leaderboard[i]._initials[2] = '\0' ; 
-        contents._leaderboard[i]._score = 0 ;
+    // text screen info
+    contents._ncols = (ncols < INTERLUDE_MAX_COLS) ? ncols : INTERLUDE_MAX_COLS ;
+    contents._nrows = (nrows < INTERLUDE_MAX_ROWS) ? nrows : INTERLUDE_MAX_ROWS ;
+    contents._fg = text ;
+    contents._bg = bg ;
+    if (render_get_draw_buffer() == NULL) {
+        render_init(contents._ncols * gl_get_char_width(), contents._nrows * gl_get_char_height(), RENDER_ARGB8888) ;
     }
-    if (FRANCIS_DEMO == 1) { // just for fun: francis (FR) gets top score :)
-        contents._leaderboard[0]._initials[0] = 'F' ; 
-        contents._leaderboard[0]._initials[1] = 'R' ; 
-        contents._leaderboard[0]._initials[2] = '\0' ; 
-        contents._leaderboard[0]._score = 99999 ;
+    interlude_text_invalidate() ;
+    interlude_text_clear() ;
+    song_parse(&interlude_song, song_interlude, song_interlude_size) ;
+
+    leaderboard_init(&board) ;
+
+    // the scores saved before (oldest first, so ties come out the same as when they were played)
+    leaderboard_log_open(&leaderboard_log, game_interlude_load_record, NULL) ;
+    if (FRANCIS_DEMO == 1 && leaderboard_log_get_count(&leaderboard_log) == 0) { // just for fun: francis (FR) gets top score :)
+        leaderboard_record_t francis = { { 'F', 'R' }, 99999, 0, 0 } ;
+        game_interlude_load_record(&francis, NULL) ;
+        leaderboard_log_append(&leaderboard_log, &francis) ;
     }
 }
 
 // display instructions
 static void game_interlude_operations(void) {
-    console_clear() ;
-    console_printf("\nLEADERBOARD!\n\n Down:\n  Set / Next\n  \n Button:\n  Change\n\n\n") ; 
+    interlude_text_clear() ;
+    interlude_text_printf("\nLEADERBOARD!\n\n Down:\n  Set / Next\n  \n Button:\n  Change\n\n\n") ; 
     int pitch = 0; int roll = 0 ;
     remote_get_x_y_status(&pitch, &roll) ;
     timer_delay(2) ;
@@ -64,8 +182,8 @@ static void game_interlude_operations(void) {
  * @exit tilt remote down
 */
 static void game_interlude_display_game_stats(unsigned int score, unsigned int lines_cleared) {
-    console_clear() ;
-    console_printf("\n score:\n  %d\n lines cleared:\n  %d", score, lines_cleared) ; 
+    interlude_text_clear() ;
+    interlude_text_printf("\n score:\n  %d\n lines cleared:\n  %d", score, lines_cleared) ; 
     int pitch = 0; int roll = 0 ;
     remote_get_x_y_status(&pitch, &roll) ;
     timer_delay(2) ;
@@ -74,54 +192,45 @@ static void game_interlude_display_game_stats(unsigned int score, unsigned int l
 
 /* game_interlude_get_user_initials
  * @functionality uses a simple state machine to prompt and read 2 letters in a user's initials
- * @returns a char* of the user's initials
+ * @returns a char* of the user's initials (contents._initials, overwritten by the next call)
  * how to use: Click button to iterate thru characters. Tilt remote down to confirm character. Characters loop from A-Z
  */
 static char* game_interlude_get_user_initials(void) {
 
-    char *initials = malloc(3) ;
+    char *initials = contents._initials ;
     initials[0] = '\0' ;
     initials[1] = '\0' ;
     initials[2] = '\0' ;
 
     // ask for input (user initials) from user
+    interlude_text_clear() ;
+    interlude_text_printf("Your Initials:\n **\n\n(Click Button)") ;
+    interlude_text_blink(1, 1, '*', ' ', 5, BLINK_DELAY) ; // (flickering effect: just the one cell)
 
-    // (flickering effect)
-    for (int i = 0; i < 5; i++) {
-        console_clear() ; 
-        console_printf("Your Initials:\n **\n\n(Click Button)") ;
-        timer_delay_ms(BLINK_DELAY) ;
-        console_clear() ; 
-        console_printf("Your Initials:\n  *\n\n(Click Button)") ;
-        timer_delay_ms(BLINK_DELAY) ;
-    }
-    console_clear() ; 
-    console_printf("Your Initials:\n **\n\n(Click Button)") ;
-
-    // gather 1st initial
+    // gather 1st initial (each click redraws just the letter)
     int first_letter = 25 ; // Z
+    char line[4] = { ' ', ' ', ' ', '\0' } ;
     int pitch = 0; int roll = 0 ;
     remote_get_x_y_status(&pitch, &roll) ;
     while (pitch != X_FAST) {
         if(remote_is_button_press()) {
             first_letter ++ ;
-            console_clear() ;
-            console_printf("Your Initials:\n %c* \n\ntilt down \n  to continue", ('A'+first_letter%26)) ;
+            line[1] = 'A' + first_letter % 26 ; line[2] = '*' ;
+            interlude_text_set_line(1, line) ;
+            interlude_text_set_line(3, "tilt down ") ;
+            interlude_text_set_line(4, "  to continue") ;
+            interlude_text_show() ;
         }
         remote_get_x_y_status(&pitch, &roll) ;
     }
 
     // (flickering effect)
-    for (int i = 0; i < 5; i++) {
-        console_clear() ; 
-        console_printf("Your Initials:\n %c*", ('A'+first_letter%26)) ;
-        timer_delay_ms(BLINK_DELAY) ;
-        console_clear() ; 
-        console_printf("Your Initials:\n %c ", ('A'+first_letter%26)) ;
-        timer_delay_ms(BLINK_DELAY) ;
-    }
-    console_clear() ; 
-    console_printf("Your Initials:\n %c*", ('A'+first_letter%26)) ;
+    line[1] = 'A' + first_letter % 26 ; line[2] = '*' ;
+    interlude_text_set_line(1, line) ;
+    interlude_text_set_line(3, "") ;
+    interlude_text_set_line(4, "") ;
+    interlude_text_show() ;
+    interlude_text_blink(1, 2, '*', ' ', 5, BLINK_DELAY) ;
 
     // gather 2nd initial
     int second_letter = 25 ; // Z
@@ -129,8 +238,9 @@ static char* game_interlude_get_user_initials(void) {
     while (pitch != X_FAST) {
         if(remote_is_button_press()) {
             second_letter ++ ;
-            console_clear() ;
-            console_printf("Your Initials:\n %c%c", ('A'+first_letter%26), ('A'+second_letter%26)) ;
+            line[2] = 'A' + second_letter % 26 ;
+            interlude_text_set_line(1, line) ;
+            interlude_text_show() ;
         }
         remote_get_x_y_status(&pitch, &roll) ;
     }
@@ -145,37 +255,28 @@ static char* game_interlude_get_user_initials(void) {
 }
 
 /* game_interlude_update_leaderboard
- * @param takes a score and adds it to the leaderboard if the score is high enough
+ * @param takes a score (and the lines cleared) and adds it to the leaderboard if the score is high enough
+ * @return the rank it got (0 if it didn't make the board)
+ * the score is saved in the leaderboard log too (one block written). when the log is full, it's compacted
+ * down to the board first -- the only scores that can ever show up on it again
  */
-static void game_interlude_update_leaderboard(unsigned int score) {
-
-    if (score >= contents._leaderboard[LEADERBOARD_SIZE-1]._score) {  // if the score is high enough for leaderboard
-
-        char* initials = game_interlude_get_user_initials() ; 
+static int game_interlude_update_leaderboard(unsigned int score, unsigned int lines_cleared) {
 
-        for(int i = LEADERBOARD_SIZE-1; i >= 0; i--) {
-            if (score < contents._leaderboard[i]._score || i == 0) { // most recent tie will be at the top
-                if(i==0 && (score >= contents._leaderboard[0]._score)) {i=-1;}  // in case we have a new high-score
+    if (leaderboard_get_rank(&board, score) > LEADERBOARD_MAX_ENTRIES) return 0 ; // (the board is full of higher scores)
 
-                // shift the scores down
-                for (int j = LEADERBOARD_SIZE-1; j > i+1; j--) { 
-                    contents._leaderboard[j]._initials[0] = contents._leaderboard[j-1]._initials[0] ;
-                    contents._leaderboard[j]._initials[1] = contents._leaderboard[j-1]._initials[1] ;
-                    contents._leaderboard[j]._initials[2] = '\0' ; // just bc; why not! :)
-                    contents._leaderboard[j]._score = contents._leaderboard[j-1]._score;
-                }
+    char* initials = game_interlude_get_user_initials() ; 
+    leaderboard_record_t record = { { initials[0], initials[1] }, score, lines_cleared, timer_get_ticks() / TICKS_PER_SEC } ;
 
-                // replace cur score with the person
-                contents._leaderboard[i+1]._initials[0] = initials[0] ;
-                contents._leaderboard[i+1]._initials[1] = initials[1] ;
-                contents._leaderboard[i+1]._initials[2] = '\0' ; // just bc; why not! :)
-                contents._leaderboard[i+1]._score = score ;
-
-                free(initials) ; 
-                break ;
-            }
+    if (leaderboard_log_get_free(&leaderboard_log) == 0) { // make room: keep just the board
+        static leaderboard_record_t keep[LEADERBOARD_MAX_ENTRIES] ;
+        int n = leaderboard_get_page(&board, 1, keep, LEADERBOARD_MAX_ENTRIES) ;
+        for (int i = 0; i < n / 2; i++) { // lowest first: loading puts them back in this order
+            leaderboard_record_t swap = keep[i] ; keep[i] = keep[n-1-i] ; keep[n-1-i] = swap ;
         }
+        leaderboard_log_compact(&leaderboard_log, keep, n) ;
     }
+    leaderboard_log_append(&leaderboard_log, &record) ;
+    return leaderboard_add(&board, &record) ;
 }
 
 /* game_interlude_print_leaderboard
@@ -186,27 +287,50 @@ static void game_interlude_update_leaderboard(unsigned int score) {
 */
 void game_interlude_print_leaderboard(unsigned int score, unsigned int lines_cleared) {
 
+    // switch to the interlude song (no interrupt re-init, so this is instant)
+    const song_t *game_song = buzzer_intr_get_song() ;
+    int game_tempo = buzzer_intr_get_tempo() ; // (the game's own: TEMPO_DEFAULT, sped up by every line cleared)
+    buzzer_intr_play_song(&interlude_song) ;
+    interlude_text_invalidate() ; // (the game was on the screen)
+
     // pre-leaderboard stuff
     game_interlude_operations() ;
     game_interlude_display_game_stats(score, lines_cleared) ; // tell the player how they did!
 
     // now, we get to the leaderboard
-    game_interlude_update_leaderboard(score) ; // need to update leaderboard first! (if worthy player)
+    int rank = game_interlude_update_leaderboard(score, lines_cleared) ; // need to update leaderboard first! (if worthy player)
 
-    console_clear() ;
-    console_printf("*LEADERBOARD*\n") ;
-    console_printf("<#>\t\t\b<n>\tSCORE\n") ;
+    // the page of the board the player placed on (the top one if they didn't make it)
+    int first = (rank > 0) ? (rank - 1) / LEADERBOARD_SIZE * LEADERBOARD_SIZE + 1 : 1 ;
+    leaderboard_record_t page[LEADERBOARD_SIZE] ;
+    int n = leaderboard_get_page(&board, first, page, LEADERBOARD_SIZE) ;
+
+    interlude_text_clear() ;
+    // the game's screen is 14 characters wide: 5 for ranks up to LEADERBOARD_MAX_ENTRIES, the initials, 6 for the score
+    interlude_text_printf("*LEADERBOARD*\n") ;
+    interlude_text_printf("  <#> <n>SCORE\n") ;
 
     for (int i = 0; i < LEADERBOARD_SIZE; i++) {
-        console_printf(" %d \t\t\b%s \t%d\n", i, contents._leaderboard[i]._initials, contents._leaderboard[i]._score) ;
+        if (i < n) interlude_text_printf("%5d %c%c%6d\n", first + i, page[i].initials[0], page[i].initials[1], page[i].score) ;
+        else interlude_text_printf("%5d **%6d\n", first + i, 0) ; // (empty spot)
+    }
+
+    if (rank > 0) {
+        interlude_text_printf("\n you placed:\n  #%d", rank) ;
+        leaderboard_record_t best ; int best_rank = 0 ;
+        if (leaderboard_get_best(&board, contents._initials, &best, &best_rank) && best_rank < rank) {
+            interlude_text_printf("\n your best:\n  #%d", best_rank) ;
+        }
     }
 
     timer_delay(1) ; 
-    console_printf("\n\nTilt down to \n  play again!") ; 
+    interlude_text_printf("\n\nTilt down to \n  play again!") ; 
     int pitch = 0; int roll = 0 ;
     remote_get_x_y_status(&pitch, &roll) ;
     while (pitch != X_FAST) {remote_get_x_y_status(&pitch, &roll) ;}
-    console_clear() ;
+    interlude_text_clear() ;
+    buzzer_intr_play_song(game_song) ; // back to the game's song
+    buzzer_intr_set_tempo(game_tempo) ; // at the game's tempo, not the song file's
 }
 
 // returns num rows in console
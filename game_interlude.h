@@ -1,27 +1,37 @@
 #ifndef _GAME_INTERLUDE_H
 #define _GAME_INTERLUDE_H
 
-#define LEADERBOARD_SIZE 5
+#include <stdbool.h>
+#include "gl.h"
 
-typedef struct {
-    char _initials[3] ; // 2 initials + \0 = 3 characters long
-    unsigned int _score;
-} leaderboard_character_t;
+#define LEADERBOARD_SIZE 5 // entries on a page of the leaderboard screen (the board itself: leaderboard.h)
+#define INTERLUDE_MAX_ROWS 30
+#define INTERLUDE_MAX_COLS 50
 
+// all statically allocated: the interlude never touches the heap
 typedef struct {
     int _nrows;
     int _ncols;
-    leaderboard_character_t* _leaderboard;
+    char _initials[3] ; // initials being entered by the player
+    // the text screen: what's on it, where the next character goes, and its colors
+    char _text[INTERLUDE_MAX_ROWS][INTERLUDE_MAX_COLS] ;
+    char _shown[INTERLUDE_MAX_ROWS][INTERLUDE_MAX_COLS] ; // what's drawn on the screen (in both buffers)
+    bool _shown_valid ; // false when something else was drawn since
+    int _row, _col ;
+    color_t _fg, _bg ;
 } interlude_contents_t;
 
 /* 'game_interlude_init'
  * initializes game screen to 
  *  @param nrows and 
- *  @param ncols wide, 
+ *  @param ncols wide (at most INTERLUDE_MAX_ROWS x INTERLUDE_MAX_COLS),
  * where every row/col size (in pixels) is determined by the character size
  * and the text and background color are determined by 
  *  @param text
  *  @param bg
+ * the interlude draws on whatever screen is up (the game's, after a game: the text is cut off at
+ * its edges), so switching between the game and the leaderboard never sets up the framebuffer again.
+ * only if there is no screen yet does it set one up, nrows x ncols characters big
  */
 void game_interlude_init(int nrows, int ncols, color_t text, color_t bg) ;
 
@@ -4,10 +4,11 @@
 * 
 * The game_update.c module consists of all the architecture and functions 
 * underlying our game of Tetris, layering on top of the gl.c and fb.c modules.
+* All of a game's state (board, score, next piece, random bag) lives in its game_t, so any number
+* of games can run at once -- only one of them should draw (headless mode, see game_update_set_headless).
 */
 
 #include "game_update.h"
-#include "malloc.h"
 #include "strings.h"
 #include "printf.h"
 #include "timer.h"
@@ -17,6 +18,26 @@
 #include "passive_buzz_intr.h"
 #include "LSD6DS33.h"
 #include "console.h"
+#include "fb.h"
+#include "render.h"
+#include "pixel_kernels.h"
+#include "input_log.h"
+#include "assert.h"
+
+#define CHECK_ROW_FILL 0 // if this == 1, every row clear first checks each row's fill count against its cells
+#ifndef SCANLINE_FRAMES // (make SCANLINE_FRAMES=1)
+#define SCANLINE_FRAMES 0 // if this == 1, frames are rendered a scanline at a time (renderScanlines, experimental: not yet timed on the board); 0 draws them layer by layer
+#endif
+#ifndef DEFERRED_DRAWING // (make DEFERRED_DRAWING=1)
+#define DEFERRED_DRAWING 0 // if this == 1, drawing is recorded and run at the end of each frame, trimmed of overdraw (see render.h)
+#endif
+
+// Drawing helpers (defined with the renderers, below; file-local, so not in game_update.h)
+static void drawRect(int x, int y, int w, int h, color_t color);
+static void drawText(int x, int y, const char* str, color_t color);
+static void drawClear(color_t color);
+static void showFrame(void);
+static void drawScore(game_t* game);
 
 /* Define the 7 Tetris pieces as piece_t structs, laying out their name, color, and rotational configurations
 Rotational configs are stored as hex numbers (bit representations). 
@@ -36,116 +57,219 @@ Here's an example of how it works for one 'j' piece configuration: 0x44C0 which
     |      |      |      |      |     
     +------+------+------+------+
 This setup supports iterating through the piece squares in a super fast and space-efficient manner! :)
+The last field is the piece's board cell (palette index), so pieces[] doubles as the board's palette.
 */
-const piece_t i = {'i', 0x1AE6DC, {0x0F00, 0x2222, 0x00F0, 0x4444}};
-const piece_t j = {'j', 0x0000E4, {0x44C0, 0x8E00, 0x6440, 0x0E20}};
-const piece_t l = {'l', 0xEA9B11, {0x4460, 0x0E80, 0xC440, 0x2E00}};
-const piece_t o = {'o', 0xE5E900, {0x6600, 0x6600, 0x6600, 0x6600}};
-const piece_t s = {'s', 0x03E800, {0x06C0, 0x8C40, 0x6C00, 0x4620}};
-const piece_t t = {'t', 0x9305E2, {0x0E40, 0x4C40, 0x4E00, 0x4640}};
-const piece_t z = {'z', 0xE80201, {0x0C60, 0x4C80, 0xC600, 0x2640}};
+const piece_t i = {'i', 0x1AE6DC, {0x0F00, 0x2222, 0x00F0, 0x4444}, 1};
+const piece_t j = {'j', 0x0000E4, {0x44C0, 0x8E00, 0x6440, 0x0E20}, 2};
+const piece_t l = {'l', 0xEA9B11, {0x4460, 0x0E80, 0xC440, 0x2E00}, 3};
+const piece_t o = {'o', 0xE5E900, {0x6600, 0x6600, 0x6600, 0x6600}, 4};
+const piece_t s = {'s', 0x03E800, {0x06C0, 0x8C40, 0x6C00, 0x4620}, 5};
+const piece_t t = {'t', 0x9305E2, {0x0E40, 0x4C40, 0x4E00, 0x4640}, 6};
+const piece_t z = {'z', 0xE80201, {0x0C60, 0x4C80, 0xC600, 0x2640}, 7};
 
 const piece_t pieces[7] = {i, j, l, o, s, t, z};
-piece_t nextFallingPiece;  
 
+color_t game_update_cell_color(int cell) {
+    return pieces[cell - 1].color;
+}
+
+#define SQUARE_DIM 20  // game square dimensions in pixels
+
+/* Frames are drawn in two layers. The playfield layer (background color + fallen squares) only changes
+when a piece locks or rows clear, so it is rasterized once into this off-screen surface and every
+frame starts with a single copy of it into the draw buffer. The overlay (next piece, score, hint,
+falling piece) is drawn on top each frame. Only a game that draws uses it, so there's just one.
+*/
 static struct {
-    int nrows;
-    int ncols;
-    color_t bg_col;
-    void* background_tracker; 
-    int gameScore;
-    int numLinesCleared; 
-    bool gameOver;
-} game_config;
-
-const unsigned int SQUARE_DIM = 20;  // game square dimensions in pixels
-
-// Required init 
-void game_update_init(int nrows, int ncols) {
-    if (game_config.background_tracker != NULL) free(game_config.background_tracker);
-    game_config.nrows = nrows;
-    game_config.ncols = ncols;
-    game_config.bg_col = GL_INDIGO;
-    game_config.gameScore = 0;
-    game_config.numLinesCleared = 0;
-    game_config.gameOver = false;
-
-    int gridSize = game_config.nrows * game_config.ncols;
-    game_config.background_tracker = malloc(gridSize * sizeof(color_t));
-    memset(game_config.background_tracker, 0, gridSize * sizeof(color_t));
-
-    random_bag_init();
-    nextFallingPiece = pieces[random_bag_choose()];
-    gl_init(game_config.ncols * SQUARE_DIM, game_config.nrows * SQUARE_DIM, GL_DOUBLEBUFFER);
-    gl_clear(game_config.bg_col);
-    gl_swap_buffer();
+    const game_t* game;         // whose board it holds (NULL = none yet)
+    unsigned int boardVersion;  // game's boardVersion when it was drawn
+    union {                     // in the screen's pixel format
+        color_t pixels[GAME_MAX_ROWS * SQUARE_DIM * GAME_MAX_COLS * SQUARE_DIM];
+        pixel16_t pixels16[GAME_MAX_ROWS * SQUARE_DIM * GAME_MAX_COLS * SQUARE_DIM];
+    };
+} playfield;
+
+/* Pixel values of the colors the scanline renderer builds frames from, in the screen's format:
+cell[0] is the background, cell[1..7] the pieces. Converted from the piece colors by game_update_init
+(so RGB565 costs no conversions per frame)
+*/
+static struct {
+    render_format_t format;
+    unsigned int cell[8];
+    unsigned int white, indigo;
+} palette;
+
+// Helper to convert the palette to the screen's pixel format
+static void initPalette(game_t* game) {
+    bool rgb565 = (render_get_format() == RENDER_RGB565);
+    palette.format = render_get_format();
+    palette.cell[0] = rgb565 ? pixel_to_565(game->bg_col) : game->bg_col;
+    for (int cell = 1; cell < 8; cell++) {
+        color_t color = game_update_cell_color(cell);
+        palette.cell[cell] = rgb565 ? pixel_to_565(color) : color;
+    }
+    palette.white = rgb565 ? pixel_to_565(GL_WHITE) : GL_WHITE;
+    palette.indigo = rgb565 ? pixel_to_565(GL_INDIGO) : GL_INDIGO;
+}
+
+// Required init (for every new game; the game_t must start out zeroed, e.g. static or `game_t game = {0};`)
+// Boards bigger than GAME_MAX_ROWS x GAME_MAX_COLS are cut down to fit
+void game_update_init(game_t* game, int nrows, int ncols) {
+    random_bag_init(&game->bag);
+    game_update_init_seeded(game, nrows, ncols, random_bag_get_seed(&game->bag));
+}
+
+// Init variant that fixes the random bag seed, so the same seed (and the same commands) 
+// always play out the same game -- used by replays
+void game_update_init_seeded(game_t* game, int nrows, int ncols, uint32_t seed) {
+    if (nrows > GAME_MAX_ROWS) nrows = GAME_MAX_ROWS;
+    if (ncols > GAME_MAX_COLS) ncols = GAME_MAX_COLS;
+    game->nrows = nrows;
+    game->ncols = ncols;
+    game->bg_col = GL_INDIGO;
+    game->gameScore = 0;
+    game->numLinesCleared = 0;
+    game->gameOver = false;
+    game->boardVersion++;
+    game->hintShown = false;
+
+    // the only reset a new game needs
+    for (int y = 0; y < game->nrows; y++) game->rowIndex[y] = y;
+    memset(game->rowFill, 0, game->nrows);
+    memset(game->background_tracker, 0, game->nrows * sizeof(board_row_t));
+
+    random_bag_set_seed(&game->bag, seed);
+    game->nextFallingPiece = pieces[random_bag_choose(&game->bag)];
+    if (game->recorder != NULL) input_log_start(game->recorder, nrows, ncols, seed);
+    if (game->headless) return;
+    render_init(game->ncols * SQUARE_DIM, game->nrows * SQUARE_DIM, game->pixelFormat);
+    initPalette(game);
+    drawClear(game->bg_col);
+    showFrame();
+}
+
+// Headless mode skips everything that only shows the game to the player (drawing, the line clear
+// pause, vibration, sound) -- the game plays out exactly the same, just as fast as possible
+void game_update_set_headless(game_t* game, bool headless) {
+    game->headless = headless;
+}
+
+// Pixel format of the screen from the next game_update_init on: RENDER_ARGB8888 (the default) or
+// RENDER_RGB565, which draws every frame in half the bytes (colors rounded to 5-6-5 bits; only in a build
+// with RGB565_FRAMES, see render.h -- otherwise the game is drawn ARGB8888)
+void game_update_set_pixel_format(game_t* game, render_format_t format) {
+    game->pixelFormat = format;
+}
+
+// Records the game's commands into rec from the next game_update_init on (NULL stops recording)
+void game_update_set_recorder(game_t* game, input_recorder_t* rec) {
+    game->recorder = rec;
+}
+
+// Outlines landing (where the falling piece would be best dropped) on every redraw; NULL hides it
+void game_update_set_hint(game_t* game, const falling_piece_t* landing) {
+    game->hintShown = (landing != NULL);
+    if (landing != NULL) game->hintPiece = *landing;
+}
+
+// Helper to record a command that changed the game (if the game is being recorded)
+static void record(game_t* game, game_cmd_t cmd) {
+    if (game->recorder != NULL) input_log_record(game->recorder, cmd);
+}
+
+// Helper to update the falling piece's fallen state (true if any square is resting on something)
+static void updateFallen(game_t* game, falling_piece_t* piece) {
+    iterateVariant(game, piece, checkIfFallen);
 }
 
 // Required init to construct and obtain a new falling piece
 // Falling piece type is selected from the elements remaining in random bag
-falling_piece_t init_falling_piece(void) {
-    draw_background();
+falling_piece_t init_falling_piece(game_t* game) {
+    if (!game->headless) draw_background(game);
 
     falling_piece_t piece;
-    piece.pieceT = nextFallingPiece;
-    nextFallingPiece = pieces[random_bag_choose()];
+    piece.pieceT = game->nextFallingPiece;
+    game->nextFallingPiece = pieces[random_bag_choose(&game->bag)];
     piece.rotation = 0;
 
     // Subtract half of each piece's 4x4 grid width from the board's center x-coordinate
     // (Representing each piece config as a hex value / bit sequence denotes the squares filled within a 4 x 4 grid) 
-    piece.x = (game_config.ncols / 2) - 2;
+    piece.x = (game->ncols / 2) - 2;
     piece.y = 0;
     piece.fallen = false;
 
     // End game if new piece drawn from random bag is not valid (coordinates out of bounds); otherwise, return chosen piece
-    if (!iterateThroughPieceSquares(&piece, checkIfValidMove)) endGame();
+    if (!iterateThroughPieceSquares(game, &piece, checkIfValidMove)) endGame(game);
     else {
-        iterateThroughPieceSquares(&piece, drawFallingSquare);
-        gl_swap_buffer();
+        updateFallen(game, &piece);
+        if (!game->headless) {
+            iterateThroughPieceSquares(game, &piece, drawFallingSquare);
+            showFrame();
+        }
     }
     return piece;
 }
 
 // Helper function to check if swap attempt is valid; returns true/false
-static bool isSwapValid(falling_piece_t piece) {
+static bool isSwapValid(game_t* game, falling_piece_t piece) {
     falling_piece_t swapPiece;
-    swapPiece.pieceT = nextFallingPiece;
+    swapPiece.pieceT = game->nextFallingPiece;
     swapPiece.rotation = piece.rotation;
     swapPiece.x = piece.x;
     swapPiece.y = piece.y;
     swapPiece.fallen = false;
 
-    if (iterateThroughPieceSquares(&swapPiece, checkIfValidMove)) return true;
+    if (iterateThroughPieceSquares(game, &swapPiece, checkIfValidMove)) return true;
     return false;
 }
 
 // Swap function to swap current falling game piece with next queued piece
-void swap(falling_piece_t* piece) {
-    if (isSwapValid(*piece)) {
+void swap(game_t* game, falling_piece_t* piece) {
+    if (isSwapValid(game, *piece)) {
         // make swap
         piece_t curr = piece->pieceT;
-        piece->pieceT = nextFallingPiece;
-        nextFallingPiece = curr;
+        piece->pieceT = game->nextFallingPiece;
+        game->nextFallingPiece = curr;
+        record(game, GAME_CMD_SWAP);
 
-        draw_background();
-        iterateThroughPieceSquares(piece, drawFallingSquare);
-        gl_swap_buffer();
+        drawPiece(game, piece);
     }
 }
 
+// All drawing goes through these helpers: straight to the screen, or into the frame's command list
+// (DEFERRED_DRAWING), which showFrame runs just before showing the frame
+static void drawRect(int x, int y, int w, int h, color_t color) {
+    if (DEFERRED_DRAWING == 1) render_list_rect(x, y, w, h, color);
+    else render_rect(x, y, w, h, color);
+}
+
+static void drawText(int x, int y, const char* str, color_t color) {
+    if (DEFERRED_DRAWING == 1) render_list_text(x, y, str, color);
+    else render_text(x, y, str, color);
+}
+
+static void drawClear(color_t color) {
+    if (DEFERRED_DRAWING == 1) render_list_rect(0, 0, gl_get_width(), gl_get_height(), color);
+    else render_clear(color);
+}
+
+static void showFrame(void) {
+    if (DEFERRED_DRAWING == 1) render_list_flush();
+    render_show();
+}
+
 // Helper function to draw bevel lines within a square given its top left (x, y) cooridinate 
+// (the outline of the square inset by 1 pixel, written straight into the draw buffer -- see render_frame)
 static void drawBevelLines(int x, int y, color_t color) {
-    gl_draw_line(x * SQUARE_DIM + 1, y * SQUARE_DIM + 1, x * SQUARE_DIM + SQUARE_DIM - 2, y * SQUARE_DIM + 1, color);
-    gl_draw_line(x * SQUARE_DIM + 1, y * SQUARE_DIM + 1, x * SQUARE_DIM + 1, y * SQUARE_DIM + SQUARE_DIM - 2, color);
-    gl_draw_line(x * SQUARE_DIM + SQUARE_DIM - 2, y * SQUARE_DIM + SQUARE_DIM - 2, x * SQUARE_DIM + SQUARE_DIM - 2, y * SQUARE_DIM + 1, color);
-    gl_draw_line(x * SQUARE_DIM + SQUARE_DIM - 2, y * SQUARE_DIM + SQUARE_DIM - 2, x * SQUARE_DIM + 1, y * SQUARE_DIM + SQUARE_DIM - 2, color);
+    if (DEFERRED_DRAWING == 1) render_list_frame(x * SQUARE_DIM + 1, y * SQUARE_DIM + 1, SQUARE_DIM - 2, SQUARE_DIM - 2, color);
+    else render_frame(x * SQUARE_DIM + 1, y * SQUARE_DIM + 1, SQUARE_DIM - 2, SQUARE_DIM - 2, color);
 }
 
 // Helper to draw square of FALLEN tetris piece specified by top left coordinate (x, y) into 
 // framebuffer (handled by gl / fb modules)
 // Function only called after valid move is verified
 static void drawFallenSquare(int x, int y, color_t color) {
-    gl_draw_rect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, color);
+    drawRect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, color);
     drawBevelLines(x, y, GL_INDIGO);
 }
 
@@ -153,7 +277,7 @@ static void drawFallenSquare(int x, int y, color_t color) {
 // each square in the tetris piece!  The coordinate locations of the squares are accessed using bitshifting!
 // If for any square in the tetris piece the action returns false, this function returns false and terminates.
 // If the action is successfully applied to all squares in the tetris piece, we return true.
-bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action) {
+bool iterateThroughPieceSquares(game_t* game, falling_piece_t* piece, functionPtr action) {
     int piece_config = (piece->pieceT).block_rotations[(int) piece->rotation];
 
     // pieceRow and pieceCol will change from 0 through 3 during loop
@@ -162,7 +286,7 @@ bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action) {
     for (int bitSequence = 0x8000; bitSequence > 0; bitSequence = bitSequence >> 1) {
         // if piece has a square in the 4x4 grid spot we're checking, perform action fn on that square
         if (piece_config & bitSequence) {
-            if (!action(piece->x + pieceCol, piece->y + pieceRow, piece)) return false;
+            if (!action(game, piece->x + pieceCol, piece->y + pieceRow, piece)) return false;
         }
         pieceCol++;
         // move to next row in grid, reset pieceCol to 0
@@ -174,27 +298,25 @@ bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action) {
 }
 
 // Helper function to check if moving a square to location (x, y) is valid
-static bool checkIfValidMove(int x, int y, falling_piece_t* piece) {
+static bool checkIfValidMove(game_t* game, int x, int y, falling_piece_t* piece) {
     // make sure (x, y) is in bounds
     if (x < 0 || y < 0) return false;
-    if (x >= game_config.ncols || y >= game_config.nrows) return false;
+    if (x >= game->ncols || y >= game->nrows) return false;
 
     // make sure another piece is not there already
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    if ((background[y][x]) != 0) return false;
+    if (game_update_get_cell(game, x, y) != BOARD_CELL_EMPTY) return false;
     return true;
 }
 
 // Input (x, y) is the top left coordinate of tetris square being drawn; 
 // function checks if square directly below is already filled --> if so, change falling piece state to fallen
-bool checkIfFallen(int x, int y, falling_piece_t* piece) {
-    if ((y + 1) >= game_config.nrows) {
+bool checkIfFallen(game_t* game, int x, int y, falling_piece_t* piece) {
+    if ((y + 1) >= game->nrows) {
         piece->fallen = true;
         return true;
     }
     else {
-        unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-        if (background[y + 1][x] != 0) {
+        if (game_update_get_cell(game, x, y + 1) != BOARD_CELL_EMPTY) {
             piece->fallen = true;
             return true;
         }
@@ -205,26 +327,33 @@ bool checkIfFallen(int x, int y, falling_piece_t* piece) {
 // Helper to draw square of FALLING tetris piece specified by top left coordinate (x, y) into 
 // framebuffer (handled by gl / fb modules)
 // Returns true always -- function only called after valid move is verified
-static bool drawFallingSquare(int x, int y, falling_piece_t* piece) {
-    gl_draw_rect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, piece->pieceT.color);
+static bool drawFallingSquare(game_t* game, int x, int y, falling_piece_t* piece) {
+    drawRect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, piece->pieceT.color);
     
     drawBevelLines(x, y, GL_WHITE);
-    checkIfFallen(x, y, piece);
+    return true;
+}
+
+// Helper to outline a square of the hint piece, in the piece's color
+static bool drawHintSquare(game_t* game, int x, int y, falling_piece_t* piece) {
+    drawBevelLines(x, y, piece->pieceT.color);
     return true;
 }
 
 // Embeds square (of tetris piece) into background tracker
 // Returns true always -- function only called after valid move is verified
-bool update_background(int x, int y, falling_piece_t* piece) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    background[y][x] = piece->pieceT.color;
+bool update_background(game_t* game, int x, int y, falling_piece_t* piece) {
+    board_row_t* row = game_update_row(game, y);
+    if (board_row_get(*row, x) == BOARD_CELL_EMPTY) game->rowFill[game->rowIndex[y]]++;
+    *row = board_row_set(*row, x, piece->pieceT.cell);
+    game->boardVersion++;
     return true;
 }
 
 // Variant of iterateThroughPieceSquares; here, if the action returns true on any piece square, this function stops
 // and returns true. 
 // Used in game loop client (located in testing.c) to check if a piece has fallen and support the "tuck" feature  
-bool iterateVariant(falling_piece_t* piece, functionPtr action) {
+bool iterateVariant(game_t* game, falling_piece_t* piece, functionPtr action) {
     int piece_config = (piece->pieceT).block_rotations[(int) piece->rotation];
 
     // pieceRow and pieceCol will change from 0 through 3 during loop
@@ -233,7 +362,7 @@ bool iterateVariant(falling_piece_t* piece, functionPtr action) {
     for (int bitSequence = 0x8000; bitSequence > 0; bitSequence = bitSequence >> 1) {
         // if piece has a square in the 4x4 grid spot we're checking, perform action fn on that square
         if (piece_config & bitSequence) {
-            if (action(piece->x + pieceCol, piece->y + pieceRow, piece)) return true;
+            if (action(game, piece->x + pieceCol, piece->y + pieceRow, piece)) return true;
         }
         pieceCol++;
         // move to next row in grid, reset pieceCol to 0
@@ -244,146 +373,333 @@ bool iterateVariant(falling_piece_t* piece, functionPtr action) {
     return false;
 }
 
-// Clears and redraws screen according to what's stored in the background tracker 
-// Called as prologue to every move/rotate function
-static void draw_background(void) {
-    gl_clear(game_config.bg_col);
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    for (int y = 0; y < game_config.nrows; y++) {
-        for (int x = 0; x < game_config.ncols; x++) {
-            // if colored square in background (from fallen piece), draw
-            if (background[y][x] != 0) {
-                // gl_draw_rect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, background[y][x]);
-                drawFallenSquare(x, y, background[y][x]);
+// Helper to draw the playfield layer (background color and fallen squares) with gl
+static void drawPlayfield(game_t* game) {
+    drawClear(game->bg_col);
+    for (int y = 0; y < game->nrows; y++) {
+        board_row_t row = *game_update_row(game, y);
+        // if colored square in background (from fallen piece), draw -- empty rows are skipped whole
+        for (int x = 0; row != 0; x++, row >>= BOARD_CELL_BITS) {
+            int cell = row & 0xf;
+            if (cell != BOARD_CELL_EMPTY) drawFallenSquare(x, y, game_update_cell_color(cell));
+        }
+    }
+}
+
+// Helper to put the playfield layer in the draw buffer: a copy of the cached surface, which is redrawn
+// (and saved) first if the board has changed since. Falls back to drawing it if the framebuffer isn't
+// the game's own (another module set it up) 
+static void composePlayfield(game_t* game) {
+    void* draw = render_get_draw_buffer();
+    int width = game->ncols * SQUARE_DIM, height = game->nrows * SQUARE_DIM;
+    bool rgb565 = (render_get_format() == RENDER_RGB565);
+    if (draw == NULL || fb_get_width() != width || fb_get_height() != height) {
+        drawPlayfield(game);
+        return;
+    }
+    if (playfield.game != game || playfield.boardVersion != game->boardVersion) {
+        drawPlayfield(game);
+        if (DEFERRED_DRAWING == 1) render_list_flush();  // (the surface is saved from the draw buffer)
+        if (rgb565) pixel_copy_rect16(playfield.pixels16, width, draw, width, width, height);
+        else pixel_copy_rect(playfield.pixels, width, draw, width, width, height);
+        playfield.game = game;
+        playfield.boardVersion = game->boardVersion;
+    } else if (DEFERRED_DRAWING == 1) {
+        render_list_blit(0, 0, width, height, playfield.pixels);
+    } else if (rgb565) {
+        pixel_copy_rect16(draw, width, playfield.pixels16, width, width, height);
+    } else {
+        pixel_copy_rect(draw, width, playfield.pixels, width, width, height);
+    }
+}
+
+// Helper to pack the pixels (palette values) that fill one 64-bit word of a scanline: p0 and p1 in
+// 32-bit formats, p0 through p3 in RGB565
+static pixel_pair_t packPixels(bool rgb565, unsigned int p0, unsigned int p1, unsigned int p2, unsigned int p3) {
+    return rgb565 ? pixel_quad16(p0, p1, p2, p3) : pixel_pair(p0, p1);
+}
+
+// Helper to check if piece has a square at board cell (x, y)
+static bool pieceCovers(const falling_piece_t* piece, int x, int y) {
+    int row = y - piece->y, col = x - piece->x;
+    if (row < 0 || row > 3 || col < 0 || col > 3) return false;
+    return (piece->pieceT.block_rotations[(int) piece->rotation] & (0x8000 >> (row * 4 + col))) != 0;
+}
+
+/* Scanline renderer: builds the whole frame (playfield, next piece box, hint, falling piece) in one
+top-to-bottom pass over the framebuffer. For each row of squares it first works out how every square
+looks -- its fill color and bevel color, the layers applied in the order they'd be drawn -- then writes
+the 20 scanlines of that row, each square's 20-pixel run as 10 pixel pairs (5 quads in RGB565): the
+bevel rows (1 and 18) and the rows between differ only in which words carry bevel pixels (so the bevels
+are spans, as with BEVEL_SPANS in render.h -- not yet checked against libmango's lines). Only the
+score text is drawn afterwards, with the piece squares under it redrawn on top as before.
+Returns false (draws nothing) if the framebuffer isn't the game's own.
+*/
+static bool renderScanlines(game_t* game, falling_piece_t* piece) {
+    pixel_pair_t* draw = render_get_draw_buffer();
+    if (draw == NULL || ((uintptr_t)draw & 7) != 0 || render_get_format() != palette.format
+        || fb_get_width() != game->ncols * SQUARE_DIM || fb_get_height() != game->nrows * SQUARE_DIM) return false;
+    falling_piece_t* hint = (piece != NULL && game->hintShown) ? &game->hintPiece : NULL;
+    bool rgb565 = (palette.format == RENDER_RGB565);
+    int words = SQUARE_DIM * (rgb565 ? sizeof(pixel16_t) : sizeof(color_t)) / sizeof(pixel_pair_t);   // per square
+
+    // the words of each square's scanlines: plain (all fill), bevel line (edge), lines between (inside)
+    pixel_pair_t fill[GAME_MAX_COLS], edge[GAME_MAX_COLS], edgeLeft[GAME_MAX_COLS], edgeRight[GAME_MAX_COLS];
+    pixel_pair_t insideLeft[GAME_MAX_COLS], insideRight[GAME_MAX_COLS];
+    for (int y = 0; y < game->nrows; y++) {
+        for (int x = 0; x < game->ncols; x++) {
+            int cell = game_update_get_cell(game, x, y);
+            unsigned int f = palette.cell[cell];
+            unsigned int b = palette.indigo;
+            bool beveled = (cell != BOARD_CELL_EMPTY);
+            if (x == game->ncols - 1 && y == 0) {   // next piece box
+                f = palette.cell[game->nextFallingPiece.cell];
+                beveled = false;
+            }
+            if (hint != NULL && pieceCovers(hint, x, y)) {
+                b = palette.cell[hint->pieceT.cell];
+                beveled = true;
             }
+            if (piece != NULL && pieceCovers(piece, x, y)) {
+                f = palette.cell[piece->pieceT.cell];
+                b = palette.white;
+                beveled = true;
+            }
+            if (!beveled) b = f;
+            fill[x] = packPixels(rgb565, f, f, f, f);
+            edge[x] = packPixels(rgb565, b, b, b, b);
+            if (rgb565) {
+                edgeLeft[x] = packPixels(rgb565, f, b, b, b);       // pixels 0-3 (low bits first)
+                edgeRight[x] = packPixels(rgb565, b, b, b, f);      // pixels 16-19
+                insideLeft[x] = packPixels(rgb565, f, b, f, f);
+                insideRight[x] = packPixels(rgb565, f, f, b, f);
+            } else {
+                edgeLeft[x] = insideLeft[x] = packPixels(rgb565, f, b, 0, 0);     // pixels 0 and 1
+                edgeRight[x] = insideRight[x] = packPixels(rgb565, b, f, 0, 0);   // pixels 18 and 19
+            }
+        }
+        for (int line = 0; line < SQUARE_DIM; line++) {
+            bool bevelLine = (line == 1 || line == SQUARE_DIM - 2);
+            bool insideLine = (line > 1 && line < SQUARE_DIM - 2);
+            for (int x = 0; x < game->ncols; x++) {
+                pixel_pair_t middle = bevelLine ? edge[x] : fill[x];
+                *draw++ = bevelLine ? edgeLeft[x] : insideLine ? insideLeft[x] : fill[x];
+                for (int word = 1; word < words - 1; word++) *draw++ = middle;
+                *draw++ = bevelLine ? edgeRight[x] : insideLine ? insideRight[x] : fill[x];
+            }
+        }
+    }
+
+    drawScore(game);
+    for (int y = 0; y * SQUARE_DIM < gl_get_char_height(); y++) {
+        for (int x = 0; x < game->ncols; x++) {
+            if (hint != NULL && pieceCovers(hint, x, y)) drawHintSquare(game, x, y, hint);
+            if (piece != NULL && pieceCovers(piece, x, y)) drawFallingSquare(game, x, y, piece);
         }
     }
+    return true;
+}
+
+// Clears and redraws screen according to what's stored in the background tracker 
+// Called as prologue to every move/rotate function
+static void draw_background(game_t* game) {
+    if (SCANLINE_FRAMES == 1 && renderScanlines(game, NULL)) return;
+    composePlayfield(game);
     // Draw in top right corner the color of next piece to fall
-    gl_draw_rect((game_config.ncols - 1) * SQUARE_DIM, 0, SQUARE_DIM, SQUARE_DIM, nextFallingPiece.color);
+    drawRect((game->ncols - 1) * SQUARE_DIM, 0, SQUARE_DIM, SQUARE_DIM, game->nextFallingPiece.color);
+    drawScore(game);
+}
 
-    // Draw score (top left of screen)
+// Helper to draw score (top left of screen)
+static void drawScore(game_t* game) {
     char buf[20];
     int bufsize = sizeof(buf);
     memset(buf, '\0', bufsize);
-    snprintf(buf, bufsize, "SCORE %d", game_config.gameScore);
-    gl_draw_string(0, 0, buf, GL_WHITE);
+    snprintf(buf, bufsize, "SCORE %d", game->gameScore);
+    drawText(0, 0, buf, GL_WHITE);
+}
+
+// Rows are reached through rowIndex, so removing one is a rotation of the indices above it: the
+// removed row's storage is emptied and reused as the new top row. Costs nrows index moves at most,
+// however wide the board is
+void game_update_remove_row(game_t* game, int y) {
+    unsigned char freed = game->rowIndex[y];
+    for (; y > 0; y--) game->rowIndex[y] = game->rowIndex[y - 1];
+    game->rowIndex[0] = freed;
+    game->background_tracker[freed] = 0;
+    game->rowFill[freed] = 0;
+    game->boardVersion++;
 }
 
 // Helper function to clear a single row, specified by the row number (y coordinate)
-static void clearRow(int row) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    for (int col = 0; col < game_config.ncols; col++) {
-        background[row][col] = 0;
+static void clearRow(game_t* game, int row) {
+    game->boardVersion++;
+    *game_update_row(game, row) = 0;
+    game->rowFill[game->rowIndex[row]] = 0;
+    if (!game->headless) {
+        draw_background(game);
+        showFrame();
+        timer_delay_ms(500);
     }
-    draw_background();
-    gl_swap_buffer();
-    timer_delay_ms(500);
 
-    for (int destRow = row; destRow > 0; destRow--) {
-        for (int col = 0; col < game_config.ncols; col++) {
-            background[destRow][col] = background[destRow - 1][col];
-        }
+    // shift the rows above down (an index rotation; no cells are copied), leaving an empty 1st row
+    game_update_remove_row(game, row);
+    if (!game->headless) {
+        draw_background(game);
+        showFrame();
+    }
+}
+
+// Debug check (CHECK_ROW_FILL) that every row's fill count matches its cells
+static void checkRowFill(game_t* game) {
+    for (int row = 0; row < game->nrows; row++) {
+        board_row_t occupied = board_row_occupied(*game_update_row(game, row));
+        int filled = 0;
+        for (; occupied != 0; occupied &= occupied - 1) filled++;
+        assert(game->rowFill[game->rowIndex[row]] == filled);
     }
-    // reset 1st row of background 
-    memset(background, 0, game_config.ncols * sizeof(color_t));
-    draw_background();
-    gl_swap_buffer();
 }
 
 // Function to clear rows and update game score accordingly
-void clearRows(void) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
+void clearRows(game_t* game) {
+    clearRowsBetween(game, 0, game->nrows - 1);
+}
+
+// Variant of clearRows that only looks at rows top through bottom -- after a lock, just the rows the
+// piece landed in can have filled up. Fill counts make each row's check a single compare
+void clearRowsBetween(game_t* game, int top, int bottom) {
+    if (CHECK_ROW_FILL == 1) checkRowFill(game);
+    if (top < 0) top = 0;
+    if (bottom >= game->nrows) bottom = game->nrows - 1;
     int rowsFilled = 0;
-    for (int row = 0; row < game_config.nrows; row++) {
-        bool rowFilled = true;
-        for (int col = 0; col < game_config.ncols; col++) {
-            // if we find an empty square, the row is not filled
-            if (background[row][col] == 0) {
-                rowFilled = false;
-                break;
+    for (int row = top; row <= bottom; row++) {
+        // the row is filled if none of its cells is empty
+        if (game->rowFill[game->rowIndex[row]] == game->ncols) {
+            if (!game->headless && rowsFilled == 0) buzzer_intr_play_effect(SFX_LINE_CLEAR);
+            clearRow(game, row); 
+            if (!game->headless) {
+                remote_vibrate(2); // remote_vibrate(rowsFilled + 1);
+                buzzer_intr_set_tempo(buzzer_intr_get_tempo() + 2) ;
             }
-        }
-        if (rowFilled) {
-            clearRow(row); 
-            remote_vibrate(2); // remote_vibrate(rowsFilled + 1);
-            buzzer_intr_set_tempo(buzzer_intr_get_tempo() + 2) ;
-            game_config.numLinesCleared++ ;
+            game->numLinesCleared++ ;
             rowsFilled++;
         }
     }
-    if (rowsFilled == 1) game_config.gameScore += 40;
-    else if (rowsFilled == 2) game_config.gameScore += 100;
-    else if (rowsFilled == 3) game_config.gameScore += 300;
-    else if (rowsFilled == 4) game_config.gameScore += 1200;
+    if (rowsFilled == 1) game->gameScore += 40;
+    else if (rowsFilled == 2) game->gameScore += 100;
+    else if (rowsFilled == 3) game->gameScore += 300;
+    else if (rowsFilled == 4) game->gameScore += 1200;
+}
+
+// Helper to draw falling tetris piece (and update whether it has fallen, which happens even when headless)
+static void drawPiece(game_t* game, falling_piece_t* piece) {
+    updateFallen(game, piece);
+    if (game->headless) return;
+    if (SCANLINE_FRAMES != 1 || !renderScanlines(game, piece)) {
+        draw_background(game);
+        if (game->hintShown) iterateThroughPieceSquares(game, &game->hintPiece, drawHintSquare);
+        iterateThroughPieceSquares(game, piece, drawFallingSquare);
+    }
+    showFrame();
+}
+
+// Locks a fallen piece into the background, clears any filled rows and spawns the next piece.
+// Returns false (and does nothing) if the piece is not resting on anything.
+// This is the "tuck" check: a fallen piece slid out from over the stack keeps falling instead.
+bool lock_piece(game_t* game, falling_piece_t* piece) {
+    if (!iterateVariant(game, piece, checkIfFallen)) return false;
+    record(game, GAME_CMD_LOCK);
+    iterateThroughPieceSquares(game, piece, update_background);
+    // inside clear rows: now, we get and update the tempo +=2 for every line cleared
+    clearRowsBetween(game, piece->y, piece->y + 3);  // (the rows of the piece's 4x4 grid)
+    *piece = init_falling_piece(game);
+    return true;
 }
 
-// Helper to draw falling tetris piece
-static void drawPiece(falling_piece_t* piece) {
-    draw_background();
-    iterateThroughPieceSquares(piece, drawFallingSquare);
-    gl_swap_buffer();
+// Returns true if piece fits on the board where it is (in bounds, not overlapping the background)
+bool game_update_piece_fits(game_t* game, falling_piece_t* piece) {
+    return iterateThroughPieceSquares(game, piece, checkIfValidMove);
+}
+
+// Runs one engine command on the falling piece (replays and the autoplayer drive the game through this)
+// Returns false only for a GAME_CMD_LOCK that couldn't lock (piece not resting on anything)
+bool game_update_run_command(game_t* game, game_cmd_t cmd, falling_piece_t* piece) {
+    switch (cmd) {
+        case GAME_CMD_LEFT: move_left(game, piece); return true;
+        case GAME_CMD_RIGHT: move_right(game, piece); return true;
+        case GAME_CMD_DOWN: move_down(game, piece); return true;
+        case GAME_CMD_ROTATE: rotate(game, piece); return true;
+        case GAME_CMD_SWAP: swap(game, piece); return true;
+        case GAME_CMD_LOCK: return lock_piece(game, piece);
+        default: return false;
+    }
 }
 
 // These next functions are move and rotate functions which do nothing for an invalid move 
-void move_down(falling_piece_t* piece) {
+void move_down(game_t* game, falling_piece_t* piece) {
     piece->y += 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
+    if (!iterateThroughPieceSquares(game, piece, checkIfValidMove)) {
         piece->y -= 1;
         return;
     };
-    drawPiece(piece);
+    record(game, GAME_CMD_DOWN);
+    drawPiece(game, piece);
 }
 
-void move_left(falling_piece_t* piece) {
+void move_left(game_t* game, falling_piece_t* piece) {
     piece->x -= 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
+    if (!iterateThroughPieceSquares(game, piece, checkIfValidMove)) {
         piece->x += 1;
         return;
     };
-    drawPiece(piece);
+    record(game, GAME_CMD_LEFT);
+    drawPiece(game, piece);
 }
 
-void move_right(falling_piece_t* piece) {
+void move_right(game_t* game, falling_piece_t* piece) {
     piece->x += 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
+    if (!iterateThroughPieceSquares(game, piece, checkIfValidMove)) {
         piece->x -= 1;
         return;
     };
-    drawPiece(piece);
+    record(game, GAME_CMD_RIGHT);
+    drawPiece(game, piece);
 }
 
-void rotate(falling_piece_t* piece) {
+void rotate(game_t* game, falling_piece_t* piece) {
     char origRotation = piece->rotation;
     piece->rotation = (origRotation + 1) % 4;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
+    if (!iterateThroughPieceSquares(game, piece, checkIfValidMove)) {
         piece->rotation = origRotation;
         return;
     };
-    drawPiece(piece);
+    record(game, GAME_CMD_ROTATE);
+    if (!game->headless) buzzer_intr_play_effect(SFX_ROTATE);
+    drawPiece(game, piece);
 }
 
 // Getters 
-int game_update_get_rows_cleared(void) {
-    return game_config.numLinesCleared;
+int game_update_get_rows_cleared(const game_t* game) {
+    return game->numLinesCleared;
 }
 
-int game_update_get_score(void) {
-    return game_config.gameScore;
+int game_update_get_score(const game_t* game) {
+    return game->gameScore;
 }
 
-bool game_update_is_game_over(void) {
-    return game_config.gameOver;
+bool game_update_is_game_over(const game_t* game) {
+    return game->gameOver;
 }
 
 // Draw game start screen
-void startGame(void) {
-    gl_clear(game_config.bg_col);
+void startGame(game_t* game) {
+    drawClear(game->bg_col);
 
     // Draw text
-    gl_draw_string(2 * SQUARE_DIM, 2 * SQUARE_DIM, "TILTRIS!", 0xCB4899);
-    gl_draw_string(SQUARE_DIM / 5, 5 * SQUARE_DIM, "Button: On/Off", 0xf9d740);
-    gl_draw_string(6 * SQUARE_DIM, 6 * SQUARE_DIM, "Music", 0xf9d740);
-    gl_draw_string(SQUARE_DIM / 2, 8 * SQUARE_DIM, "Tilt to Play!", 0x219756);
+    drawText(2 * SQUARE_DIM, 2 * SQUARE_DIM, "TILTRIS!", 0xCB4899);
+    drawText(SQUARE_DIM / 5, 5 * SQUARE_DIM, "Button: On/Off", 0xf9d740);
+    drawText(6 * SQUARE_DIM, 6 * SQUARE_DIM, "Music", 0xf9d740);
+    drawText(SQUARE_DIM / 2, 8 * SQUARE_DIM, "Tilt to Play!", 0x219756);
 
     // DRAW 107 MANGO
     // Draw 1 (as i piece)
@@ -422,7 +738,7 @@ void startGame(void) {
     drawFallenSquare(8, 16, s.color); 
     drawFallenSquare(9, 16, s.color); 
 
-    gl_swap_buffer();
+    showFrame();
 
     // Wait for downward tilt of remote
     timer_delay(2) ;
@@ -438,14 +754,16 @@ void startGame(void) {
 }
 
 // End game screen
-void endGame(void) {
-    draw_background();
+void endGame(game_t* game) {
+    game->gameOver = true;
+    if (game->headless) return;
+    draw_background(game);
     char buf[20];
     int bufsize = sizeof(buf);
     snprintf(buf, bufsize, " GAME OVER ");
-    gl_draw_string(SQUARE_DIM, game_config.ncols / 2 * SQUARE_DIM, buf, GL_WHITE);
-    gl_swap_buffer();
-    game_config.gameOver = true;
+    drawText(SQUARE_DIM, game->ncols / 2 * SQUARE_DIM, buf, GL_WHITE);
+    showFrame();
+    buzzer_intr_play_effect(SFX_GAME_OVER);
 }
 
 // uart-driven pause function - helpful for testing purposes
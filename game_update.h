@@ -2,17 +2,20 @@
 #define _GAME_UPDATE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "gl.h"
+#include "random_bag.h"
+#include "render.h"
 
 typedef struct {
     char name;
     color_t color;
     int block_rotations[4];
+    unsigned char cell;     // what its squares are stored as on the board: its index in pieces[] + 1
 } piece_t;
 
 extern const piece_t i, j, l, o, s, t, z;
 extern const piece_t pieces[7];
-extern piece_t nextFallingPiece;
 
 typedef struct {
     piece_t pieceT;
@@ -22,54 +25,168 @@ typedef struct {
     bool fallen;    // true/false to specify whether piece has fallen in its place
 } falling_piece_t;
 
-falling_piece_t init_falling_piece(void);
-
-void game_update_init(int nrows, int ncols);
-
-typedef bool (*functionPtr)(int x, int y, falling_piece_t* piece); 
+struct input_recorder;
+
+// Biggest board a game_t holds. Every game's board is stored in the game_t itself, so starting a game
+// (or a new one) never allocates, and many games can run at once without sharing anything
+#define GAME_MAX_ROWS 32
+#define GAME_MAX_COLS 16    // a whole row fits in one board_row_t
+
+// The board is stored packed: each cell is a 4-bit palette index (BOARD_CELL_EMPTY, or the cell of the
+// piece that fell there), and a row is one 64-bit word with column x in bits 4x..4x+3. Colors are only
+// looked up when drawing (game_update_cell_color), so a 10x20 board is 160 bytes, and rows can be
+// tested, compared and copied a word at a time with the helpers below
+typedef uint64_t board_row_t;
+
+#define BOARD_CELL_BITS 4
+#define BOARD_CELL_EMPTY 0
+#define BOARD_ROW_ONES 0x1111111111111111ULL   // lowest bit of every cell
+
+// Cell in column x of row
+static inline int board_row_get(board_row_t row, int x) {
+    return (row >> (x * BOARD_CELL_BITS)) & 0xf;
+}
+
+// row with column x set to cell
+static inline board_row_t board_row_set(board_row_t row, int x, int cell) {
+    int shift = x * BOARD_CELL_BITS;
+    return (row & ~(0xfULL << shift)) | ((board_row_t)cell << shift);
+}
+
+// The lowest bit of each of the first ncols cells
+static inline board_row_t board_row_mask(int ncols) {
+    return (ncols >= GAME_MAX_COLS) ? BOARD_ROW_ONES : BOARD_ROW_ONES & ((1ULL << (ncols * BOARD_CELL_BITS)) - 1);
+}
+
+// Lowest bit of every non-empty cell set, all else clear
+static inline board_row_t board_row_occupied(board_row_t row) {
+    return (row | row >> 1 | row >> 2 | row >> 3) & BOARD_ROW_ONES;
+}
+
+// True if none of the first ncols cells is empty (checks the whole row at once)
+static inline bool board_row_is_full(board_row_t row, int ncols) {
+    board_row_t mask = board_row_mask(ncols);
+    return (board_row_occupied(row) & mask) == mask;
+}
+
+// One game of Tetris. Every engine function takes the game it acts on; games share no state
+typedef struct {
+    int nrows;
+    int ncols;
+    color_t bg_col;
+    int gameScore;
+    int numLinesCleared; 
+    bool gameOver;
+    bool headless;  // true to skip all drawing, delays, vibration and sound (fast replays / simulation)
+    render_format_t pixelFormat;    // how the screen is drawn (see game_update_set_pixel_format)
+    piece_t nextFallingPiece;
+    random_bag_t bag;
+    struct input_recorder* recorder;  // where commands are recorded (NULL = not recorded)
+    unsigned int boardVersion;  // changes whenever the background does (pieces locked, rows cleared, new game)
+    bool hintShown;
+    falling_piece_t hintPiece;  // landing spot outlined under the falling piece (see hint.h)
+    unsigned char rowIndex[GAME_MAX_ROWS];  // where the board's row y is stored in background_tracker, so
+                                            // clearing a row only moves indices (see game_update_remove_row)
+    unsigned char rowFill[GAME_MAX_ROWS];   // filled cells of each stored row (indexed like background_tracker,
+                                            // so counts move with their rows): a row is full at ncols
+    board_row_t background_tracker[GAME_MAX_ROWS];  // fallen squares, one packed row each (see board_row_t);
+                                                    // kept last so copies can stop after the rows in use
+} game_t;
+
+// The board's row y (0 = top) -- always reach rows through here (or game_update_get_cell), never
+// background_tracker directly
+static inline board_row_t* game_update_row(game_t* game, int y) {
+    return &game->background_tracker[game->rowIndex[y]];
+}
+
+// Cell at (x, y): BOARD_CELL_EMPTY or the cell of the piece that fell there
+static inline int game_update_get_cell(const game_t* game, int x, int y) {
+    return board_row_get(game->background_tracker[game->rowIndex[y]], x);
+}
+
+// Takes row y out of the board: the rows above it move down one and an empty row comes in on top
+void game_update_remove_row(game_t* game, int y);
+
+// Palette: the color a (non-empty) cell is drawn in
+color_t game_update_cell_color(int cell);
+
+falling_piece_t init_falling_piece(game_t* game);
+
+void game_update_init(game_t* game, int nrows, int ncols);
+
+void game_update_init_seeded(game_t* game, int nrows, int ncols, uint32_t seed);
+
+void game_update_set_headless(game_t* game, bool headless);
+
+void game_update_set_recorder(game_t* game, struct input_recorder* rec);
+
+void game_update_set_hint(game_t* game, const falling_piece_t* landing);
+
+void game_update_set_pixel_format(game_t* game, render_format_t format);
+
+// Engine commands, as recorded in the input log (see input_log.h) and re-run by replays
+typedef enum {
+    GAME_CMD_LEFT = 0,
+    GAME_CMD_RIGHT,
+    GAME_CMD_DOWN,      // gravity tick or tilt-down drop
+    GAME_CMD_ROTATE,
+    GAME_CMD_SWAP,
+    GAME_CMD_LOCK,      // lock_piece: piece embedded, rows cleared, next piece spawned
+    GAME_CMD_COUNT
+} game_cmd_t;
+
+typedef bool (*functionPtr)(game_t* game, int x, int y, falling_piece_t* piece); 
+
+bool iterateThroughPieceSquares(game_t* game, falling_piece_t* piece, functionPtr action);
+
+static bool checkIfValidMove(game_t* game, int x, int y, falling_piece_t* piece);
+
+static bool drawFallingSquare(game_t* game, int x, int y, falling_piece_t* piece);
 
-bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action);
+static void drawFallenSquare(int x, int y, color_t color);
 
-static bool checkIfValidMove(int x, int y, falling_piece_t* piece);
+static void drawBevelLines(int x, int y, color_t color);
 
-static bool drawFallingSquare(int x, int y, falling_piece_t* piece);
+bool update_background(game_t* game, int x, int y, falling_piece_t* piece);
 
-static void drawFallenSquare(int x, int y, color_t color);
+static void draw_background(game_t* game);
 
-static void drawBevelLines(int x, int y, color_t color);
+void swap(game_t* game, falling_piece_t* piece);
 
-bool update_background(int x, int y, falling_piece_t* piece);
+void move_down(game_t* game, falling_piece_t* piece);
 
-static void draw_background(void);
+void move_left(game_t* game, falling_piece_t* piece);
 
-void swap(falling_piece_t* piece);
+void move_right(game_t* game, falling_piece_t* piece);
 
-void move_down(falling_piece_t* piece);
+void rotate(game_t* game, falling_piece_t* piece);
 
-void move_left(falling_piece_t* piece);
+bool checkIfFallen(game_t* game, int x, int y, falling_piece_t* piece);
 
-void move_right(falling_piece_t* piece);
+bool lock_piece(game_t* game, falling_piece_t* piece);
 
-void rotate(falling_piece_t* piece);
+bool game_update_piece_fits(game_t* game, falling_piece_t* piece);
 
-bool checkIfFallen(int x, int y, falling_piece_t* piece);
+bool game_update_run_command(game_t* game, game_cmd_t cmd, falling_piece_t* piece);
 
-static void drawPiece(falling_piece_t* piece);
+static void drawPiece(game_t* game, falling_piece_t* piece);
 
-void endGame(void);
+void endGame(game_t* game);
 
-void startGame(void);
+void startGame(game_t* game);
 
 void pause(const char *message);
 
-void clearRows(void);
+void clearRows(game_t* game);
+
+void clearRowsBetween(game_t* game, int top, int bottom);
 
-int game_update_get_rows_cleared(void) ;
+int game_update_get_rows_cleared(const game_t* game) ;
 
-int game_update_get_score(void) ;
+int game_update_get_score(const game_t* game) ;
 
-bool game_update_is_game_over(void) ;
+bool game_update_is_game_over(const game_t* game) ;
 
-bool iterateVariant(falling_piece_t* piece, functionPtr action);
+bool iterateVariant(game_t* game, falling_piece_t* piece, functionPtr action);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,58 @@
+/* hint.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The hint.c module works out (on the Mango Pi, a little at a time) where the falling piece would
+* best be dropped, using the autoplayer's search -- and so game_update's own collision checks.
+*/
+
+#include "hint.h"
+#include "cycle_count.h"
+#include <stddef.h>
+
+void hint_init(hint_t* hint) {
+    hint->searching = false;
+    hint->ready = false;
+    hint->boardVersion = 0;
+    hint->pieceName = 0;
+    hint->searches = 0;
+    hint->cycles = 0;
+}
+
+// Helper to check if the search in progress (or finished) is still for this board and piece
+static bool isStale(const hint_t* hint, const game_t* game, const falling_piece_t* piece) {
+    return game->boardVersion != hint->boardVersion || piece->pieceT.name != hint->pieceName;
+}
+
+bool hint_update(hint_t* hint, game_t* game, const falling_piece_t* piece, unsigned long budget_cycles) {
+    unsigned long start = cycle_count_read();
+    if (isStale(hint, game, piece)) {   // (always, the first time)
+        hint->searches++;
+        game_update_set_hint(game, NULL);
+        autoplay_search_begin(&hint->search, game, piece, false);  // hints are for the piece you have
+        hint->boardVersion = game->boardVersion;
+        hint->pieceName = piece->pieceT.name;
+        hint->searching = true;
+        hint->ready = false;
+    }
+    if (hint->searching) {
+        bool done;
+        do {
+            done = autoplay_search_next(&hint->search);
+        } while (!done && cycle_count_read() - start < budget_cycles);
+
+        if (done) {
+            hint->searching = false;
+            hint->ready = (hint->search.best.candidate >= 0);
+            if (hint->ready) {
+                falling_piece_t landing = hint->search.piece;
+                landing.rotation = hint->search.best.rotation;
+                landing.x = hint->search.best.x;
+                landing.y = hint->search.best.y;
+                game_update_set_hint(game, &landing);
+            }
+        }
+    }
+    hint->cycles += cycle_count_read() - start;
+    return hint->ready;
+}
@@ -0,0 +1,31 @@
+#ifndef _HINT_H
+#define _HINT_H
+
+#include <stdbool.h>
+#include "autoplay.h"
+
+// Placement hint: the autoplayer's best landing spot for the falling piece, outlined on the board.
+// The search runs a slice at a time (hint_update, within a cycle budget) so it never holds up a frame.
+// The finished hint is kept until the board changes (a piece locks / rows clear) or the falling piece
+// changes (new piece or swap), which throw away the work in progress and start over.
+
+#define HINT_DEFAULT_BUDGET_CYCLES 200000   // 200us of the D1's 1GHz per call
+
+typedef struct {
+    autoplay_search_t search;
+    bool searching;
+    bool ready;                 // search finished and the game is showing its landing spot
+    unsigned int boardVersion;  // game's boardVersion when the search began
+    char pieceName;             // falling piece the search is for
+    unsigned long searches;     // searches started (each board change or new piece starts one)
+    unsigned long cycles;       // cycles spent searching in total
+} hint_t;
+
+void hint_init(hint_t* hint);
+
+// Does up to budget_cycles of search for the falling piece (at least one candidate), restarting if
+// what it had is stale. When the search finishes the game is told to outline the landing spot
+// (game_update_set_hint). Returns true while a finished hint is showing
+bool hint_update(hint_t* hint, game_t* game, const falling_piece_t* piece, unsigned long budget_cycles);
+
+#endif
@@ -0,0 +1,157 @@
+/* bot_main.c
+ * Autoplayer on the computer: plays long headless games with the autoplay bot and reports how fast
+ * it goes. Each piece's candidate placements are evaluated in parallel: the main thread and
+ * (threads - 1) helpers each take every threads'th candidate, then the best of their bests is played.
+ *
+ * Usage: host/bot [-g games] [-t threads] [-s first_seed] [-p max_pieces_per_game] [-n (no swap)]
+ * The moves chosen don't depend on the number of threads, so the results only differ in speed.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "autoplay.h"
+
+#define NROWS 20
+#define NCOLS 10
+#define MAX_THREADS 64
+
+static struct {
+    int ngames;
+    int nthreads;
+    uint32_t first_seed;
+    int max_pieces;
+    bool allow_swap;
+} config = { 1, 1, 1, 2000, true };
+
+// The piece being searched, shared read-only with the helpers between the two barriers
+static struct {
+    game_t *game;
+    falling_piece_t piece;
+    bool done;
+    pthread_barrier_t start, finish;
+} job;
+
+typedef struct {
+    int id;
+    pthread_t thread;
+    autoplay_scratch_t scratch;
+    autoplay_move_t best;
+    unsigned long evaluated;
+} __attribute__((aligned(64))) evaluator_t;
+
+static evaluator_t evaluators[MAX_THREADS];
+
+static void evaluate_share(evaluator_t *e) {
+    e->best.candidate = -1;
+    int n = autoplay_num_candidates(job.game);
+    for (int c = e->id; c < n; c += config.nthreads) {
+        autoplay_move_t move;
+        if (autoplay_evaluate(job.game, &job.piece, config.allow_swap, c, &e->scratch, &move)) {
+            autoplay_keep_best(&e->best, &move);
+            e->evaluated++;
+        }
+    }
+}
+
+static void *run_helper(void *arg) {
+    evaluator_t *e = arg;
+    while (1) {
+        pthread_barrier_wait(&job.start);
+        if (job.done) return NULL;
+        evaluate_share(e);
+        pthread_barrier_wait(&job.finish);
+    }
+}
+
+// Finds the best move for piece with every evaluator
+static autoplay_move_t find_move(game_t *game, const falling_piece_t *piece) {
+    job.game = game;
+    job.piece = *piece;
+    if (config.nthreads > 1) pthread_barrier_wait(&job.start);
+    evaluate_share(&evaluators[0]);
+    if (config.nthreads > 1) pthread_barrier_wait(&job.finish);
+
+    autoplay_move_t best = { .candidate = -1, .rotation = piece->rotation, .x = piece->x };
+    for (int t = 0; t < config.nthreads; t++) autoplay_keep_best(&best, &evaluators[t].best);
+    return best;
+}
+
+// Plays one game with the bot; returns the number of pieces placed
+static int play_game(game_t *game, uint32_t seed, unsigned long *commands) {
+    game_update_init_seeded(game, NROWS, NCOLS, seed);
+    falling_piece_t piece = init_falling_piece(game);
+    int pieces = 0;
+    while (!game_update_is_game_over(game) && pieces < config.max_pieces) {
+        autoplay_move_t move = find_move(game, &piece);
+        game_cmd_t cmd = GAME_CMD_DOWN;
+        for (int steps = 0; cmd != GAME_CMD_LOCK && steps < NROWS * NCOLS; steps++) { // (a blocked move ends early)
+            cmd = autoplay_next_command(game, &move, &piece);
+            game_update_run_command(game, cmd, &piece);
+            (*commands)++;
+        }
+        if (cmd == GAME_CMD_LOCK) pieces++;
+    }
+    return pieces;
+}
+
+static double now_secs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+    int i = 1;
+    for (; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0) config.allow_swap = false;
+        else if (i + 1 == argc) break;
+        else if (strcmp(argv[i], "-g") == 0) config.ngames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-t") == 0) config.nthreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-s") == 0) config.first_seed = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "-p") == 0) config.max_pieces = atoi(argv[++i]);
+        else break;
+    }
+    if (i < argc || config.ngames < 1 || config.nthreads < 1 || config.nthreads > MAX_THREADS || config.max_pieces < 1) {
+        fprintf(stderr, "usage: %s [-g games] [-t threads] [-s first_seed] [-p max_pieces_per_game] [-n]\n", argv[0]);
+        return 2;
+    }
+
+    pthread_barrier_init(&job.start, NULL, config.nthreads);
+    pthread_barrier_init(&job.finish, NULL, config.nthreads);
+    for (int t = 0; t < config.nthreads; t++) {
+        evaluators[t].id = t;
+        if (t > 0) pthread_create(&evaluators[t].thread, NULL, run_helper, &evaluators[t]);
+    }
+
+    static game_t game;
+    game_update_set_headless(&game, true);
+    unsigned long pieces = 0, lines = 0, commands = 0;
+    long score = 0;
+    double start = now_secs();
+    for (int g = 0; g < config.ngames; g++) {
+        int n = play_game(&game, config.first_seed + g, &commands);
+        printf("game %d (seed %u): %d pieces, %d lines, score %d%s\n", g, (unsigned int)(config.first_seed + g), n,
+               game_update_get_rows_cleared(&game), game_update_get_score(&game),
+               game_update_is_game_over(&game) ? ", game over" : "");
+        pieces += n;
+        lines += game_update_get_rows_cleared(&game);
+        score += game_update_get_score(&game);
+    }
+    double secs = now_secs() - start;
+
+    job.done = true;
+    if (config.nthreads > 1) pthread_barrier_wait(&job.start);
+    unsigned long evaluated = 0;
+    for (int t = 0; t < config.nthreads; t++) {
+        if (t > 0) pthread_join(evaluators[t].thread, NULL);
+        evaluated += evaluators[t].evaluated;
+    }
+
+    printf("%lu pieces, %lu lines, total score %ld, %lu commands, %lu placements evaluated on %d threads in %.3f s\n",
+           pieces, lines, score, commands, evaluated, config.nthreads, secs);
+    printf("%.0f pieces/s, %.0f placements evaluated/s\n", pieces / secs, evaluated / secs);
+    return 0;
+}
@@ -0,0 +1,140 @@
+/* game_main.c
+ * The whole game on Linux: runs integration_test_v10 (the demo game loop in testing.c, remote and
+ * interlude included) against the stand-in devices in host/hal_*.c, on the virtual clock, and reports
+ * how fast it ran. The same seed (or script) and clock step always play the same games.
+ *
+ * Usage: host/game [-t seconds] [-g games] [-s seed] [-r period_ms] [-i script] [-o frame.ppm]
+ *                  [-c usec_per_clock_read] [-p v10|autoplay] [-P profile_hz] [-d 1]
+ *                  [-l leaderboard_file]
+ *   -t  stop after this much game time (virtual seconds, default 600)
+ *   -g  stop at the end of this many games (default: no limit)
+ *   -s  seed of the random player (default 1), which picks a tilt/click every -r ms (default 150)
+ *   -i  play a script file instead (see host/hal_script.c)
+ *   -o  save the screen as a PPM image when done
+ *   -p  autoplay runs test_autoplay instead (the autoplayer, drawn)
+ *   -P  profile the whole run with profiler.h, dumped at the end (tools/profile_symbolize.py ... --nm nm)
+ *   -d  1 to print a digest of every frame shown (golden-frame checks: make host-golden, host/golden.txt)
+ *   -l  keep the storage (the leaderboard log) in this file, so the leaderboard carries over to the next
+ *       run (default: in memory, a fresh leaderboard every run)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "testing.h"
+#include "passive_buzz_intr.h"
+#include "profiler.h"
+#include "render.h"
+#include "timer.h"
+#include "hal.h"
+
+#define BUTTON GPIO_PB0     // as wired in integration_test_v10's remote_init
+
+static struct {
+    double seconds;
+    int games;
+    uint32_t seed;
+    int period_ms;
+    const char *script;
+    const char *ppm;
+    int step_usec;
+    const char *program;
+    int profile_hz;
+    bool digest;
+    const char *storage;
+} config = { 600, 0, 1, 150, NULL, NULL, 1, "v10", 0, false, NULL };
+
+static struct timespec start;
+
+static double wall_seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static void finish(void) {
+    double wall = wall_seconds();
+    if (config.profile_hz > 0) {
+        profiler_stop();
+        profiler_dump();
+    }
+    double game = host_timer_now() / (1e6 * TICKS_PER_USEC);
+    unsigned long frames = host_gl_get_swaps();
+    printf("\nHOSTGAME %.1f s of game time in %.3f s (%.0fx real time)\n", game, wall, wall > 0 ? game / wall : 0);
+    printf("frames %lu (%.1f us each), games %lu, line clears %lu, rotations %lu\n", frames,
+           frames ? wall * 1e6 / frames : 0, host_buzzer_get_effects(SFX_GAME_OVER),
+           host_buzzer_get_effects(SFX_LINE_CLEAR), host_buzzer_get_effects(SFX_ROTATE));
+    printf("i2c transactions %lu, button clicks %lu, servo pulses %lu\n", host_i2c_get_transactions(),
+           host_script_get_clicks(), host_gpio_rising_edges(GPIO_PB1));
+    render_stats_t draws = render_list_get_stats();
+    if (draws.recorded > 0) {   // (DEFERRED_DRAWING in game_update.c)
+        printf("draw commands recorded %lu, issued %lu, culled %lu, merged %lu (%.1f issued per frame)\n",
+               draws.recorded, draws.issued, draws.culled, draws.merged, frames ? (double)draws.issued / frames : 0);
+    }
+    if (config.digest) printf("frame digest %016llx\n", (unsigned long long)host_gl_get_digest());
+    if (config.ppm != NULL && !host_gl_dump_ppm(config.ppm)) fprintf(stderr, "could not write %s\n", config.ppm);
+    fflush(stdout);
+    exit(0);
+}
+
+// Runs on every step of the virtual clock: moves the player, and ends the run at the limits
+static void clock_hook(unsigned long ticks) {
+    host_script_poll(ticks);
+    if (ticks >= config.seconds * 1e6 * TICKS_PER_USEC) finish();
+    if (config.games > 0 && host_buzzer_get_effects(SFX_GAME_OVER) >= (unsigned long)config.games) finish();
+}
+
+static void usage(void) {
+    fprintf(stderr, "usage: host/game [-t seconds] [-g games] [-s seed] [-r period_ms] [-i script] [-o frame.ppm] "
+                    "[-c usec_per_clock_read] [-p v10|autoplay] [-P profile_hz] [-d 1] [-l leaderboard_file]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-' || argv[i][1] == '\0' || argv[i][2] != '\0' || i + 1 == argc) usage();
+        const char *value = argv[++i];
+        switch (argv[i - 1][1]) {
+            case 't': config.seconds = atof(value); break;
+            case 'g': config.games = atoi(value); break;
+            case 's': config.seed = strtoul(value, NULL, 0); break;
+            case 'r': config.period_ms = atoi(value); break;
+            case 'i': config.script = value; break;
+            case 'o': config.ppm = value; break;
+            case 'c': config.step_usec = atoi(value); break;
+            case 'p': config.program = value; break;
+            case 'P': config.profile_hz = atoi(value); break;
+            case 'd': config.digest = atoi(value) != 0; break;
+            case 'l': config.storage = value; break;
+            default: usage();
+        }
+    }
+    if (config.seconds <= 0 || config.period_ms <= 0 || config.step_usec <= 0) usage();
+
+    if (config.script != NULL) {
+        if (!host_script_load(config.script, BUTTON)) {
+            fprintf(stderr, "could not load script %s\n", config.script);
+            return 1;
+        }
+    } else {
+        host_script_random(config.seed, config.period_ms, BUTTON);
+    }
+    if (config.storage != NULL && !host_storage_set_file(config.storage)) {
+        fprintf(stderr, "could not open %s\n", config.storage);
+        return 1;
+    }
+    host_timer_set_step(config.step_usec * TICKS_PER_USEC);
+    host_timer_set_hook(clock_hook);
+    host_gl_set_digest(config.digest);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (config.profile_hz > 0) {
+        profiler_init(config.profile_hz);
+        profiler_start();
+    }
+
+    if (strcmp(config.program, "autoplay") == 0) test_autoplay();
+    else if (strcmp(config.program, "v10") == 0) integration_test_v10();
+    else usage();
+    return 0;
+}
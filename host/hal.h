@@ -0,0 +1,69 @@
+/* hal.h
+ * Host backend of the hardware abstraction layer: how host/game drives and inspects the stand-in devices.
+ *
+ * The hardware boundary is the set of modules the game calls for hardware -- libmango's gl, console,
+ * timer, gpio, gpio_interrupt, interrupts and uart, plus our own i2c, passive_buzz_intr, profiler and storage --
+ * and the game code only ever reaches hardware through their headers. On the Mango Pi those are libmango
+ * and the drivers in the top directory; on Linux the headers in host/include and these implementations
+ * take their place, so every other module (the engine, remote.c, LSD6DS33.c, servo.c,
+ * game_interlude.c, testing.c) builds unchanged:
+ *
+ *      hal_gl.c        gl + console into an in-memory framebuffer (readable, dumpable as PPM)
+ *      hal_timer.c     virtual clock: deterministic, and delays take no real time
+ *      hal_gpio.c      pin levels, edge counts, gpio interrupts (handlers run when a pin is driven)
+ *      hal_devices.c   i2c bus with an LSM6DS33 accelerometer on it, buzzer, uart
+ *      hal_script.c    scripted or random player: tilts the accelerometer and clicks the button
+ *      hal_profiler.c  profiler.h on SIGPROF, same dump format as the Mango Pi's
+ *      hal_storage.c   storage.h blocks in a file (or in memory), for the leaderboard log
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gl.h"
+#include "gpio.h"
+
+// framebuffer: the buffer on screen (the front buffer when double buffered)
+const color_t *host_gl_get_frame(int *width, int *height);
+bool host_gl_dump_ppm(const char *path);
+unsigned long host_gl_get_swaps(void);
+// digest of every frame shown since it was turned on (FNV-1a over the pixels, frame after frame): equal
+// digests mean identical screens all the way through -- golden-frame checks (make host-golden) compare it
+void host_gl_set_digest(bool on);
+uint64_t host_gl_get_digest(void);
+
+// virtual clock: every timer_get_ticks() moves time forward by step ticks (so polling loops end),
+// delays move it forward by the delay. The hook runs after every step (never re-entered)
+void host_timer_set_step(unsigned long ticks);
+void host_timer_set_hook(void (*hook)(unsigned long ticks));
+unsigned long host_timer_now(void);     // current time without moving the clock
+void host_timer_advance(unsigned long ticks);
+
+// gpio: drive an input pin from outside (runs its gpio interrupt handler on a matching edge)
+void host_gpio_drive(gpio_id_t pin, int level);
+int host_gpio_level(gpio_id_t pin);
+unsigned long host_gpio_rising_edges(gpio_id_t pin);
+
+// accelerometer on the i2c bus: raw readings, or a tilt (X_HOME/X_FAST/X_SWAP, LEFT/HOME/RIGHT from
+// LSD6DS33.h) turned into readings past LSD6DS33.c's calibrated thresholds
+void host_accel_set(short x, short y, short z);
+void host_accel_tilt(int pitch, int roll);
+unsigned long host_i2c_get_transactions(void);
+
+// buzzer
+unsigned long host_buzzer_get_effects(int effect);
+
+// player: a script file of "<ms> <event>" lines (see hal_script.c), or random tilts and clicks
+bool host_script_load(const char *path, gpio_id_t button);
+void host_script_random(uint32_t seed, int period_ms, gpio_id_t button);
+void host_script_poll(unsigned long ticks);
+unsigned long host_script_get_clicks(void);
+
+// storage: the blocks are kept in the file at path from now on (created if missing; NULL: in memory,
+// the default). Returns false if the file can't be opened
+bool host_storage_set_file(const char *path);
+unsigned long host_storage_get_writes(void);
+
+#endif
@@ -0,0 +1,136 @@
+/* hal_devices.c
+ * Host backend for the devices behind our own drivers:
+ *  - i2c.h: a bus with an LSM6DS33 on it (register file, auto-incrementing reads), standing in for the
+ *    bit-banged i2c.c. LSD6DS33.c runs unchanged on top; the readings come from host_accel_set/tilt
+ *  - passive_buzz_intr.h: a silent buzzer that keeps the same state (song, tempo, paused) and counts effects
+ *  - uart (stdin/stdout), from libmango
+ */
+
+#include <stdio.h>
+#include "i2c.h"
+#include "LSD6DS33.h"
+#include "passive_buzz_intr.h"
+#include "song_assets.h"
+#include "timer.h"
+#include "uart.h"
+#include "hal.h"
+
+// i2c
+
+// i2c.c bit-bangs every byte with a 1ms pause after its ack, plus 100us around start and stop;
+// transactions here take the same virtual time so the game loop keeps the board's pace
+#define I2C_TRANSACTION_USEC 200
+#define I2C_BYTE_USEC 1022
+
+#define ACCEL_ADDR 0x6B
+#define ACCEL_WHO_AM_I 0x0F
+#define ACCEL_OUTX_L 0x28
+#define ACCEL_ID 0x69
+
+static struct {
+    unsigned char regs[128];
+    unsigned char pointer;      // register the next read or write goes to
+    unsigned long transactions;
+} accel = { .regs = { [ACCEL_WHO_AM_I] = ACCEL_ID } };
+
+static void charge(int nbytes) {
+    timer_delay_us(I2C_TRANSACTION_USEC + (nbytes + 1) * I2C_BYTE_USEC); // + 1 for the address byte
+}
+
+void i2c_init(void) {}
+
+// The first byte sets the register pointer, the rest are written from there on (outputs are read-only)
+void i2c_write(unsigned char device_id, unsigned char *data, int data_length) {
+    charge(data_length);
+    accel.transactions++;
+    if (device_id != ACCEL_ADDR || data_length == 0) return;
+    accel.pointer = data[0] & 0x7f;
+    for (int i = 1; i < data_length; i++, accel.pointer = (accel.pointer + 1) & 0x7f) {
+        if (accel.pointer < ACCEL_OUTX_L) accel.regs[accel.pointer] = data[i];
+    }
+}
+
+// Nothing else is on the bus: other addresses read as 0xff (no one pulling sda down)
+void i2c_read(unsigned char device_id, unsigned char *data, int data_length) {
+    charge(data_length);
+    accel.transactions++;
+    for (int i = 0; i < data_length; i++) {
+        if (device_id != ACCEL_ADDR) data[i] = 0xff;
+        else {
+            data[i] = accel.regs[accel.pointer];
+            accel.pointer = (accel.pointer + 1) & 0x7f;
+        }
+    }
+}
+
+void host_accel_set(short x, short y, short z) {
+    short axes[3] = { x, y, z };
+    for (int i = 0; i < 3; i++) {
+        accel.regs[ACCEL_OUTX_L + 2 * i] = axes[i] & 0xff;
+        accel.regs[ACCEL_OUTX_L + 2 * i + 1] = (axes[i] >> 8) & 0xff;
+    }
+}
+
+// Readings well past LSD6DS33.c's calibrated angles (pitch only counts while roll is HOME)
+void host_accel_tilt(int pitch, int roll) {
+    short y = (roll == LEFT) ? -12000 : (roll == RIGHT) ? 11000 : -2000;
+    short x = (pitch == X_FAST) ? 12000 : (pitch == X_SWAP) ? -15000 : 0;
+    host_accel_set(x, y, 16384); // z: 1g
+}
+
+unsigned long host_i2c_get_transactions(void) {
+    return accel.transactions;
+}
+
+// buzzer
+
+static struct {
+    song_t tetris;
+    const song_t *song;
+    int tempo;
+    bool playing;
+    unsigned long effects[SFX_COUNT];
+} buzzer;
+
+void buzzer_intr_init(gpio_id_t id, int tempo_) {
+    gpio_set_output(id);
+    song_parse(&buzzer.tetris, song_tetris, song_tetris_size);
+    buzzer.song = &buzzer.tetris;
+    buzzer_intr_set_tempo(tempo_);
+    buzzer.playing = true;
+}
+
+void buzzer_intr_set_tempo(int tempo_) {
+    if (tempo_ < TEMPO_MIN) tempo_ = TEMPO_MIN;
+    if (tempo_ > TEMPO_MAX) tempo_ = TEMPO_MAX;
+    buzzer.tempo = tempo_;
+}
+
+int buzzer_intr_get_tempo(void) { return buzzer.tempo; }
+
+void buzzer_intr_play_song(const song_t *song) {
+    buzzer_intr_set_tempo(song->tempo);
+    buzzer.song = song;
+}
+
+const song_t *buzzer_intr_get_song(void) { return buzzer.song; }
+const song_t *buzzer_intr_get_default_song(void) { return &buzzer.tetris; }
+void buzzer_intr_restart_song(void) {}
+void buzzer_intr_pause(void) { buzzer.playing = false; }
+void buzzer_intr_play(void) { buzzer.playing = true; }
+bool buzzer_intr_is_playing(void) { return buzzer.playing; }
+
+void buzzer_intr_play_effect(int effect) {
+    if (effect >= 0 && effect < SFX_COUNT) buzzer.effects[effect]++;
+}
+
+unsigned long host_buzzer_get_effects(int effect) {
+    return (effect >= 0 && effect < SFX_COUNT) ? buzzer.effects[effect] : 0;
+}
+
+// uart
+
+void uart_init(void) {}
+int uart_getchar(void) { return getchar(); }
+int uart_putchar(int ch) { return putchar(ch); }
+bool uart_haschar(void) { return false; }
@@ -0,0 +1,283 @@
+/* hal_gl.c
+ * Host backend for gl, font and console: draws into an in-memory framebuffer instead of the HDMI display.
+ * Same buffer model as libmango (double buffered: draw into the back buffer, gl_swap_buffer shows it)
+ * and the same 14x16 character cell, so screens lay out like on the Mango Pi. The glyphs are a
+ * classic 5x7 font drawn at 2x; libmango's own font isn't available off the board.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gl.h"
+#include "fb.h"
+#include "console.h"
+#include "font.h"
+#include "hal.h"
+
+#define CHAR_WIDTH 14
+#define CHAR_HEIGHT 16
+#define GLYPH_SCALE 2
+#define GLYPH_X 2       // where the scaled 10x14 glyph sits in its cell
+#define GLYPH_Y 1
+
+// 5x7 glyphs for ' ' .. '~', one byte per column, bit 0 at the top
+static const unsigned char font5x7[95][5] = {
+    {0x00,0x00,0x00,0x00,0x00}, {0x00,0x00,0x5F,0x00,0x00}, {0x00,0x07,0x00,0x07,0x00}, {0x14,0x7F,0x14,0x7F,0x14},
+    {0x24,0x2A,0x7F,0x2A,0x12}, {0x23,0x13,0x08,0x64,0x62}, {0x36,0x49,0x55,0x22,0x50}, {0x00,0x05,0x03,0x00,0x00},
+    {0x00,0x1C,0x22,0x41,0x00}, {0x00,0x41,0x22,0x1C,0x00}, {0x08,0x2A,0x1C,0x2A,0x08}, {0x08,0x08,0x3E,0x08,0x08},
+    {0x00,0x50,0x30,0x00,0x00}, {0x08,0x08,0x08,0x08,0x08}, {0x00,0x60,0x60,0x00,0x00}, {0x20,0x10,0x08,0x04,0x02},
+    {0x3E,0x51,0x49,0x45,0x3E}, {0x00,0x42,0x7F,0x40,0x00}, {0x42,0x61,0x51,0x49,0x46}, {0x21,0x41,0x45,0x4B,0x31},
+    {0x18,0x14,0x12,0x7F,0x10}, {0x27,0x45,0x45,0x45,0x39}, {0x3C,0x4A,0x49,0x49,0x30}, {0x01,0x71,0x09,0x05,0x03},
+    {0x36,0x49,0x49,0x49,0x36}, {0x06,0x49,0x49,0x29,0x1E}, {0x00,0x36,0x36,0x00,0x00}, {0x00,0x56,0x36,0x00,0x00},
+    {0x08,0x14,0x22,0x41,0x00}, {0x14,0x14,0x14,0x14,0x14}, {0x00,0x41,0x22,0x14,0x08}, {0x02,0x01,0x51,0x09,0x06},
+    {0x32,0x49,0x79,0x41,0x3E}, {0x7E,0x11,0x11,0x11,0x7E}, {0x7F,0x49,0x49,0x49,0x36}, {0x3E,0x41,0x41,0x41,0x22},
+    {0x7F,0x41,0x41,0x22,0x1C}, {0x7F,0x49,0x49,0x49,0x41}, {0x7F,0x09,0x09,0x09,0x01}, {0x3E,0x41,0x49,0x49,0x7A},
+    {0x7F,0x08,0x08,0x08,0x7F}, {0x00,0x41,0x7F,0x41,0x00}, {0x20,0x40,0x41,0x3F,0x01}, {0x7F,0x08,0x14,0x22,0x41},
+    {0x7F,0x40,0x40,0x40,0x40}, {0x7F,0x02,0x0C,0x02,0x7F}, {0x7F,0x04,0x08,0x10,0x7F}, {0x3E,0x41,0x41,0x41,0x3E},
+    {0x7F,0x09,0x09,0x09,0x06}, {0x3E,0x41,0x51,0x21,0x5E}, {0x7F,0x09,0x19,0x29,0x46}, {0x46,0x49,0x49,0x49,0x31},
+    {0x01,0x01,0x7F,0x01,0x01}, {0x3F,0x40,0x40,0x40,0x3F}, {0x1F,0x20,0x40,0x20,0x1F}, {0x3F,0x40,0x38,0x40,0x3F},
+    {0x63,0x14,0x08,0x14,0x63}, {0x07,0x08,0x70,0x08,0x07}, {0x61,0x51,0x49,0x45,0x43}, {0x00,0x7F,0x41,0x41,0x00},
+    {0x02,0x04,0x08,0x10,0x20}, {0x00,0x41,0x41,0x7F,0x00}, {0x04,0x02,0x01,0x02,0x04}, {0x40,0x40,0x40,0x40,0x40},
+    {0x00,0x01,0x02,0x04,0x00}, {0x20,0x54,0x54,0x54,0x78}, {0x7F,0x48,0x44,0x44,0x38}, {0x38,0x44,0x44,0x44,0x20},
+    {0x38,0x44,0x44,0x48,0x7F}, {0x38,0x54,0x54,0x54,0x18}, {0x08,0x7E,0x09,0x01,0x02}, {0x0C,0x52,0x52,0x52,0x3E},
+    {0x7F,0x08,0x04,0x04,0x78}, {0x00,0x44,0x7D,0x40,0x00}, {0x20,0x40,0x44,0x3D,0x00}, {0x7F,0x10,0x28,0x44,0x00},
+    {0x00,0x41,0x7F,0x40,0x00}, {0x7C,0x04,0x18,0x04,0x78}, {0x7C,0x08,0x04,0x04,0x78}, {0x38,0x44,0x44,0x44,0x38},
+    {0x7C,0x14,0x14,0x14,0x08}, {0x08,0x14,0x14,0x18,0x7C}, {0x7C,0x08,0x04,0x04,0x08}, {0x48,0x54,0x54,0x54,0x20},
+    {0x04,0x3F,0x44,0x40,0x20}, {0x3C,0x40,0x40,0x20,0x7C}, {0x1C,0x20,0x40,0x20,0x1C}, {0x3C,0x40,0x30,0x40,0x3C},
+    {0x44,0x28,0x10,0x28,0x44}, {0x0C,0x50,0x50,0x50,0x3C}, {0x44,0x64,0x54,0x4C,0x44}, {0x00,0x08,0x36,0x41,0x00},
+    {0x00,0x00,0x7F,0x00,0x00}, {0x00,0x41,0x36,0x08,0x00}, {0x08,0x04,0x08,0x10,0x08},
+};
+
+static struct {
+    int width, height;
+    gl_mode_t mode;
+    color_t *buffers[2];
+    color_t *front;     // on screen
+    color_t *draw;      // drawn into (the same as front when single buffered)
+    unsigned long swaps;
+} fb;
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static struct {
+    bool on;
+    uint64_t hash;
+} digest;
+
+void gl_init(int width, int height, gl_mode_t mode) {
+    size_t npixels = (size_t)width * height;
+    for (int i = 0; i < 2; i++) {
+        free(fb.buffers[i]);
+        fb.buffers[i] = calloc(npixels ? npixels : 1, sizeof(color_t));
+        for (size_t p = 0; p < npixels; p++) fb.buffers[i][p] = GL_BLACK;
+    }
+    fb.width = width;
+    fb.height = height;
+    fb.mode = mode;
+    fb.front = fb.buffers[0];
+    fb.draw = (mode == GL_DOUBLEBUFFER) ? fb.buffers[1] : fb.buffers[0];
+}
+
+int gl_get_width(void) { return fb.width; }
+int gl_get_height(void) { return fb.height; }
+int gl_get_char_width(void) { return CHAR_WIDTH; }
+int gl_get_char_height(void) { return CHAR_HEIGHT; }
+
+// fb: the same buffers, for code that writes pixels itself
+void fb_init(int width, int height, fb_mode_t mode) { gl_init(width, height, (gl_mode_t)mode); }
+int fb_get_width(void) { return fb.width; }
+int fb_get_height(void) { return fb.height; }
+int fb_get_depth(void) { return sizeof(color_t); }
+void *fb_get_draw_buffer(void) { return fb.draw; }
+void fb_swap_buffer(void) { gl_swap_buffer(); }
+
+color_t gl_color(unsigned char r, unsigned char g, unsigned char b) {
+    return 0xFF000000 | (r << 16) | (g << 8) | b;
+}
+
+void gl_swap_buffer(void) {
+    if (fb.mode == GL_DOUBLEBUFFER) {
+        color_t *tmp = fb.front;
+        fb.front = fb.draw;
+        fb.draw = tmp;
+    }
+    fb.swaps++;
+    if (!digest.on) return;
+    size_t npixels = (size_t)fb.width * fb.height;
+    uint64_t hash = digest.hash ^ (uint64_t)fb.width << 32 ^ fb.height;
+    for (size_t p = 0; p < npixels; p++) hash = (hash ^ fb.front[p]) * FNV_PRIME;
+    digest.hash = hash;
+}
+
+void gl_clear(color_t c) {
+    size_t npixels = (size_t)fb.width * fb.height;
+    for (size_t p = 0; p < npixels; p++) fb.draw[p] = c;
+}
+
+void gl_draw_pixel(int x, int y, color_t c) {
+    if (x < 0 || y < 0 || x >= fb.width || y >= fb.height) return;
+    fb.draw[(size_t)y * fb.width + x] = c;
+}
+
+color_t gl_read_pixel(int x, int y) {
+    if (x < 0 || y < 0 || x >= fb.width || y >= fb.height) return 0;
+    return fb.draw[(size_t)y * fb.width + x];
+}
+
+void gl_draw_rect(int x, int y, int w, int h, color_t c) {
+    int x0 = x < 0 ? 0 : x, y0 = y < 0 ? 0 : y;
+    int x1 = x + w > fb.width ? fb.width : x + w;
+    int y1 = y + h > fb.height ? fb.height : y + h;
+    for (int row = y0; row < y1; row++) {
+        color_t *p = fb.draw + (size_t)row * fb.width;
+        for (int col = x0; col < x1; col++) p[col] = c;
+    }
+}
+
+// Bresenham, both endpoints included. libmango's is anti-aliased (Wu), so lines, i.e. the bevels, don't
+// come out as on the board
+void gl_draw_line(int x1, int y1, int x2, int y2, color_t c) {
+    int dx = abs(x2 - x1), sx = x1 < x2 ? 1 : -1;
+    int dy = -abs(y2 - y1), sy = y1 < y2 ? 1 : -1;
+    int err = dx + dy;
+    while (1) {
+        gl_draw_pixel(x1, y1, c);
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x1 += sx; }
+        if (e2 <= dx) { err += dx; y1 += sy; }
+    }
+}
+
+// font: each 5x7 glyph scaled up into a character cell, one byte per pixel
+int font_get_glyph_height(void) { return CHAR_HEIGHT; }
+int font_get_glyph_width(void) { return CHAR_WIDTH; }
+int font_get_glyph_size(void) { return CHAR_WIDTH * CHAR_HEIGHT; }
+
+bool font_get_glyph(char ch, unsigned char buf[], size_t buflen) {
+    if (ch < ' ' || ch > '~' || buflen < (size_t)font_get_glyph_size()) return false;
+    const unsigned char *glyph = font5x7[ch - ' '];
+    memset(buf, 0, font_get_glyph_size());
+    for (int y = GLYPH_Y; y < GLYPH_Y + 7 * GLYPH_SCALE; y++) {
+        for (int x = GLYPH_X; x < GLYPH_X + 5 * GLYPH_SCALE; x++) {
+            if (glyph[(x - GLYPH_X) / GLYPH_SCALE] & (1 << (y - GLYPH_Y) / GLYPH_SCALE)) buf[y * CHAR_WIDTH + x] = 0xff;
+        }
+    }
+    return true;
+}
+
+// Only the glyph's own pixels are drawn; the background shows through
+void gl_draw_char(int x, int y, char ch, color_t c) {
+    unsigned char glyph[CHAR_WIDTH * CHAR_HEIGHT];
+    if (!font_get_glyph(ch, glyph, sizeof(glyph))) return;
+    for (int row = 0; row < CHAR_HEIGHT; row++) {
+        for (int col = 0; col < CHAR_WIDTH; col++) {
+            if (glyph[row * CHAR_WIDTH + col]) gl_draw_pixel(x + col, y + row, c);
+        }
+    }
+}
+
+void gl_draw_string(int x, int y, const char *str, color_t c) {
+    for (; *str != '\0'; str++, x += CHAR_WIDTH) gl_draw_char(x, y, *str, c);
+}
+
+const color_t *host_gl_get_frame(int *width, int *height) {
+    *width = fb.width;
+    *height = fb.height;
+    return fb.front;
+}
+
+unsigned long host_gl_get_swaps(void) {
+    return fb.swaps;
+}
+
+void host_gl_set_digest(bool on) {
+    if (on && !digest.on) digest.hash = FNV_OFFSET;
+    digest.on = on;
+}
+
+uint64_t host_gl_get_digest(void) {
+    return digest.hash;
+}
+
+bool host_gl_dump_ppm(const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) return false;
+    fprintf(f, "P6\n%d %d\n255\n", fb.width, fb.height);
+    for (size_t p = 0; p < (size_t)fb.width * fb.height; p++) {
+        unsigned char rgb[3] = { (fb.front[p] >> 16) & 0xff, (fb.front[p] >> 8) & 0xff, fb.front[p] & 0xff };
+        fwrite(rgb, 1, sizeof(rgb), f);
+    }
+    return fclose(f) == 0;
+}
+
+// console: a text buffer that is redrawn in full (and shown) after every console_printf, like libmango's
+#define CONSOLE_TAB 4
+
+static struct {
+    int nrows, ncols;
+    color_t fg, bg;
+    char *text;
+    int row, col;
+} con;
+
+void console_init(int nrows, int ncols, color_t foreground, color_t background) {
+    con.nrows = nrows;
+    con.ncols = ncols;
+    con.fg = foreground;
+    con.bg = background;
+    free(con.text);
+    con.text = malloc((size_t)nrows * ncols);
+    gl_init(ncols * CHAR_WIDTH, nrows * CHAR_HEIGHT, GL_DOUBLEBUFFER);
+    console_clear();
+}
+
+static void console_redraw(void) {
+    gl_clear(con.bg);
+    for (int row = 0; row < con.nrows; row++) {
+        for (int col = 0; col < con.ncols; col++) {
+            gl_draw_char(col * CHAR_WIDTH, row * CHAR_HEIGHT, con.text[row * con.ncols + col], con.fg);
+        }
+    }
+    gl_swap_buffer();
+}
+
+void console_clear(void) {
+    memset(con.text, ' ', (size_t)con.nrows * con.ncols);
+    con.row = con.col = 0;
+    console_redraw();
+}
+
+static void console_newline(void) {
+    con.col = 0;
+    if (++con.row < con.nrows) return;
+    memmove(con.text, con.text + con.ncols, (size_t)(con.nrows - 1) * con.ncols); // scroll up a line
+    memset(con.text + (con.nrows - 1) * con.ncols, ' ', con.ncols);
+    con.row = con.nrows - 1;
+}
+
+static void console_put(char ch) {
+    switch (ch) {
+        case '\n': console_newline(); break;
+        case '\r': con.col = 0; break;
+        case '\b': if (con.col > 0) con.col--; break;
+        case '\f': memset(con.text, ' ', (size_t)con.nrows * con.ncols); con.row = con.col = 0; break;
+        case '\t': do console_put(' '); while (con.col % CONSOLE_TAB != 0); break;
+        default:
+            if (con.col == con.ncols) console_newline();
+            con.text[con.row * con.ncols + con.col++] = ch;
+    }
+}
+
+int console_printf(const char *format, ...) {
+    char buf[1024];
+    va_list ap;
+    va_start(ap, format);
+    int n = vsnprintf(buf, sizeof(buf), format, ap);
+    va_end(ap);
+    for (const char *s = buf; *s != '\0'; s++) console_put(*s);
+    console_redraw();
+    return n;
+}
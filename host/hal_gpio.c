@@ -0,0 +1,175 @@
+/* hal_gpio.c
+ * Host backend for gpio, gpio_extra, gpio_interrupt and interrupts. Pins are levels in memory: the
+ * program writes its outputs (edges are counted, e.g. servo pulses), host_gpio_drive sets inputs from
+ * outside. A gpio interrupt is "raised" when a driven edge matches the pin's configured event, and its
+ * handler runs right away (if interrupts are enabled), the way it would preempt the program on the board.
+ */
+
+#include <stddef.h>
+#include "gpio.h"
+#include "gpio_extra.h"
+#include "gpio_interrupt.h"
+#include "interrupts.h"
+#include "hal.h"
+
+#define NGROUPS 8
+#define PINS_PER_GROUP 32
+#define NPINS (NGROUPS * PINS_PER_GROUP)
+
+typedef struct {
+    unsigned int function;
+    int level;
+    unsigned long rising_edges;
+    struct {
+        gpio_event_t event;
+        bool enabled;
+        bool pending;
+        handlerfn_t fn;
+        void *aux_data;
+    } intr;
+} pin_t;
+
+static pin_t pins[NPINS];
+
+static struct {
+    bool enabled;
+    bool in_handler;
+} interrupts;
+
+static pin_t *get_pin(gpio_id_t id) {
+    int group = id >> 8, num = id & 0xff;
+    if (group >= NGROUPS || num >= PINS_PER_GROUP) return NULL;
+    return &pins[group * PINS_PER_GROUP + num];
+}
+
+// gpio
+
+void gpio_init(void) {}
+
+void gpio_set_function(gpio_id_t id, unsigned int function) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL) pin->function = function;
+}
+
+unsigned int gpio_get_function(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    return pin != NULL ? pin->function : GPIO_FN_DISABLED;
+}
+
+void gpio_set_input(gpio_id_t id) { gpio_set_function(id, GPIO_FN_INPUT); }
+void gpio_set_output(gpio_id_t id) { gpio_set_function(id, GPIO_FN_OUTPUT); }
+
+// Helper to run a pending interrupt's handler; it stays pending while interrupts are off
+static void run_handler(pin_t *pin) {
+    if (!interrupts.enabled || interrupts.in_handler || pin->intr.fn == NULL) return;
+    interrupts.in_handler = true;
+    pin->intr.fn((uintptr_t)__builtin_return_address(0), pin->intr.aux_data);
+    interrupts.in_handler = false;
+}
+
+// Helper to change a pin's level, counting edges and raising its interrupt if the edge matches
+static void set_level(pin_t *pin, int level) {
+    level = level ? 1 : 0;
+    int prev = pin->level;
+    pin->level = level;
+    if (level == prev) return;
+    if (level) pin->rising_edges++;
+
+    gpio_event_t event = pin->intr.event;
+    bool matches = (event == GPIO_INTERRUPT_DOUBLE_EDGE)
+                || (event == GPIO_INTERRUPT_POSITIVE_EDGE && level)
+                || (event == GPIO_INTERRUPT_NEGATIVE_EDGE && !level)
+                || (event == GPIO_INTERRUPT_HIGH_LEVEL && level)
+                || (event == GPIO_INTERRUPT_LOW_LEVEL && !level);
+    if (!matches || !pin->intr.enabled) return;
+    pin->intr.pending = true;
+    run_handler(pin);
+}
+
+void gpio_write(gpio_id_t id, int val) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL && pin->function == GPIO_FN_OUTPUT) set_level(pin, val);
+}
+
+int gpio_read(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    return pin != NULL ? pin->level : 0;
+}
+
+void gpio_set_pullup(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL && pin->function == GPIO_FN_INPUT) pin->level = 1;
+}
+
+void gpio_set_pulldown(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL && pin->function == GPIO_FN_INPUT) pin->level = 0;
+}
+
+void gpio_set_pullnone(gpio_id_t id) {}
+
+void host_gpio_drive(gpio_id_t id, int level) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL && pin->function == GPIO_FN_INPUT) set_level(pin, level);
+}
+
+int host_gpio_level(gpio_id_t id) {
+    return gpio_read(id);
+}
+
+unsigned long host_gpio_rising_edges(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    return pin != NULL ? pin->rising_edges : 0;
+}
+
+// gpio_interrupt
+
+void gpio_interrupt_init(void) {}
+
+void gpio_interrupt_config(gpio_id_t id, gpio_event_t event, bool debounce) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL) pin->intr.event = event;
+}
+
+void gpio_interrupt_register_handler(gpio_id_t id, handlerfn_t fn, void *aux_data) {
+    pin_t *pin = get_pin(id);
+    if (pin == NULL) return;
+    pin->intr.fn = fn;
+    pin->intr.aux_data = aux_data;
+}
+
+void gpio_interrupt_enable(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL) pin->intr.enabled = true;
+}
+
+void gpio_interrupt_disable(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL) pin->intr.enabled = false;
+}
+
+void gpio_interrupt_clear(gpio_id_t id) {
+    pin_t *pin = get_pin(id);
+    if (pin != NULL) pin->intr.pending = false;
+}
+
+// interrupts: only gpio interrupts are ever raised on the host (the buzzer and profiler don't use timers here)
+
+void interrupts_init(void) {
+    interrupts.enabled = false;
+}
+
+void interrupts_global_enable(void) {
+    interrupts.enabled = true;
+    for (int i = 0; i < NPINS; i++) {
+        if (pins[i].intr.pending && pins[i].intr.enabled) run_handler(&pins[i]);
+    }
+}
+
+void interrupts_global_disable(void) {
+    interrupts.enabled = false;
+}
+
+bool interrupts_enable_source(interrupt_source_t source) { return true; }
+bool interrupts_disable_source(interrupt_source_t source) { return true; }
+void interrupts_register_handler(interrupt_source_t source, handlerfn_t fn, void *aux_data) {}
@@ -0,0 +1,87 @@
+/* hal_profiler.c
+ * Host backend for profiler.h: SIGPROF (process cpu time) takes the samples instead of TIMER0, and the
+ * interrupted pc comes out of the signal context. Same histogram and dump format as profiler.c, based at
+ * the start of the executable, so tools/profile_symbolize.py reads it with --nm nm (host/game is linked
+ * -no-pie, so addresses match the symbol table).
+ */
+
+#define _GNU_SOURCE
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ucontext.h>
+#include "profiler.h"
+
+extern char __executable_start[];
+
+static struct {
+    unsigned int buckets[PROFILER_NBUCKETS];
+    volatile unsigned long samples;
+    volatile unsigned long outside;
+    int rate_hz;
+} profile;
+
+static uintptr_t context_pc(void *context) {
+    ucontext_t *uc = context;
+#if defined(__x86_64__)
+    return uc->uc_mcontext.gregs[REG_RIP];
+#elif defined(__aarch64__)
+    return uc->uc_mcontext.pc;
+#elif defined(__riscv)
+    return uc->uc_mcontext.__gregs[REG_PC];
+#else
+    return 0;
+#endif
+}
+
+static void handle_sample(int sig, siginfo_t *info, void *context) {
+    uintptr_t offset = context_pc(context) - (uintptr_t)__executable_start;
+    if (offset < (uintptr_t)PROFILER_NBUCKETS * PROFILER_BUCKET_SIZE) profile.buckets[offset / PROFILER_BUCKET_SIZE]++;
+    else profile.outside++;
+    profile.samples++;
+}
+
+void profiler_init(int rate_hz) {
+    if (rate_hz <= 0) rate_hz = 1;
+    profile.rate_hz = rate_hz;
+    profiler_reset();
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_sigaction = handle_sample;
+    sa.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGPROF, &sa, NULL);
+}
+
+static void set_interval(long usecs) {
+    struct itimerval it = { { 0, usecs }, { 0, usecs } };
+    setitimer(ITIMER_PROF, &it, NULL);
+}
+
+void profiler_start(void) {
+    long usecs = 1000000 / profile.rate_hz;
+    set_interval(usecs > 0 ? usecs : 1);
+}
+
+void profiler_stop(void) {
+    set_interval(0);
+}
+
+void profiler_reset(void) {
+    memset(profile.buckets, 0, sizeof(profile.buckets));
+    profile.samples = 0;
+    profile.outside = 0;
+}
+
+void profiler_dump(void) {
+    uintptr_t base = (uintptr_t)__executable_start;
+    printf("\nPROFILE base=0x%lx bucket=%d rate=%d samples=%ld outside=%ld\n",
+           (unsigned long)base, PROFILER_BUCKET_SIZE, profile.rate_hz, profile.samples, profile.outside);
+    for (int i = 0; i < PROFILER_NBUCKETS; i++) {
+        if (profile.buckets[i] != 0) printf("0x%lx %d\n", (unsigned long)(base + i * PROFILER_BUCKET_SIZE), profile.buckets[i]);
+    }
+    printf("END\n");
+}
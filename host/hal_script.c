@@ -0,0 +1,156 @@
+/* hal_script.c
+ * The player for host/game: moves the stand-in remote (accelerometer tilt, button clicks) as the
+ * virtual clock passes. Either a script file, one event per line at an absolute time in ms:
+ *
+ *      # comment
+ *      0     home          tilts: home, left, right, fast (tilted down), swap (tilted up)
+ *      2100  fast
+ *      2500  click         button press
+ *      2600  accel -9000 0 16384   raw accelerometer reading (x y z)
+ *
+ * or a random player that picks a new tilt (and sometimes clicks) every period.
+ * Either way the same input at the same virtual time gives the same game.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "LSD6DS33.h"
+#include "timer.h"
+#include "hal.h"
+
+#define MAX_EVENTS 4096
+#define CLICK_USEC 20000     // how long the button is held down
+
+typedef enum { EVENT_TILT, EVENT_CLICK, EVENT_ACCEL } event_type_t;
+
+typedef struct {
+    unsigned long ticks;
+    event_type_t type;
+    short a, b, c;      // tilt: pitch, roll; accel: x, y, z
+} event_t;
+
+static struct {
+    event_t *events;
+    int nevents, next;
+    bool random;
+    uint32_t rand_state;
+    unsigned long period_ticks, next_ticks;
+    gpio_id_t button;
+    unsigned long release_ticks;    // when the held button goes back up (0: not held)
+    unsigned long clicks;
+} player;
+
+static void click(unsigned long now) {
+    host_gpio_drive(player.button, 1);
+    player.release_ticks = now + CLICK_USEC * TICKS_PER_USEC;
+    player.clicks++;
+}
+
+static bool parse_line(const char *line, event_t *event) {
+    unsigned long ms;
+    char name[16];
+    int x, y, z;
+    if (sscanf(line, "%lu %15s", &ms, name) != 2) return false;
+    event->ticks = ms * 1000 * TICKS_PER_USEC;
+    event->type = EVENT_TILT;
+    event->a = X_HOME;
+    event->b = HOME;
+    if (strcmp(name, "home") == 0) return true;
+    if (strcmp(name, "left") == 0) { event->b = LEFT; return true; }
+    if (strcmp(name, "right") == 0) { event->b = RIGHT; return true; }
+    if (strcmp(name, "fast") == 0) { event->a = X_FAST; return true; }
+    if (strcmp(name, "swap") == 0) { event->a = X_SWAP; return true; }
+    if (strcmp(name, "click") == 0) { event->type = EVENT_CLICK; return true; }
+    if (strcmp(name, "accel") == 0 && sscanf(line, "%*u %*s %d %d %d", &x, &y, &z) == 3) {
+        event->type = EVENT_ACCEL;
+        event->a = x; event->b = y; event->c = z;
+        return true;
+    }
+    return false;
+}
+
+bool host_script_load(const char *path, gpio_id_t button) {
+    FILE *f = fopen(path, "r");
+    if (f == NULL) return false;
+    free(player.events);
+    player.events = malloc(MAX_EVENTS * sizeof(event_t));
+    player.nevents = player.next = 0;
+    player.random = false;
+    player.button = button;
+
+    char line[128];
+    int lineno = 0;
+    bool ok = true;
+    while (fgets(line, sizeof(line), f) != NULL && ok) {
+        lineno++;
+        char *s = line + strspn(line, " \t");
+        if (*s == '#' || *s == '\n' || *s == '\0') continue;
+        if (player.nevents == MAX_EVENTS || !parse_line(s, &player.events[player.nevents])) {
+            fprintf(stderr, "%s:%d: bad event (or more than %d)\n", path, lineno, MAX_EVENTS);
+            ok = false;
+        } else if (player.nevents > 0 && player.events[player.nevents].ticks < player.events[player.nevents - 1].ticks) {
+            fprintf(stderr, "%s:%d: events must be in time order\n", path, lineno);
+            ok = false;
+        }
+        player.nevents++;
+    }
+    fclose(f);
+    return ok;
+}
+
+void host_script_random(uint32_t seed, int period_ms, gpio_id_t button) {
+    player.nevents = player.next = 0;
+    player.random = true;
+    player.rand_state = seed * 2654435761u + 1;
+    player.period_ticks = (unsigned long)period_ms * 1000 * TICKS_PER_USEC;
+    player.next_ticks = 0;
+    player.button = button;
+}
+
+// xorshift32
+static uint32_t next_rand(void) {
+    uint32_t x = player.rand_state;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return player.rand_state = x;
+}
+
+// Random player: half the time level, otherwise left/right/down (and rarely up to swap);
+// clicks (rotate, or the next letter on the leaderboard) every few periods
+static void random_step(unsigned long now) {
+    uint32_t r = next_rand();
+    int roll = HOME, pitch = X_HOME;
+    switch (r % 16) {
+        case 0: case 1: case 2: roll = LEFT; break;
+        case 3: case 4: case 5: roll = RIGHT; break;
+        case 6: case 7: pitch = X_FAST; break;
+        case 8: pitch = X_SWAP; break;
+        default: break;
+    }
+    host_accel_tilt(pitch, roll);
+    if ((r >> 4) % 4 == 0 && player.release_ticks == 0) click(now);
+}
+
+void host_script_poll(unsigned long now) {
+    if (player.release_ticks != 0 && now >= player.release_ticks) {
+        host_gpio_drive(player.button, 0);
+        player.release_ticks = 0;
+    }
+    if (player.random) {
+        while (now >= player.next_ticks) {
+            random_step(now);
+            player.next_ticks += player.period_ticks;
+        }
+        return;
+    }
+    for (; player.next < player.nevents && player.events[player.next].ticks <= now; player.next++) {
+        const event_t *event = &player.events[player.next];
+        if (event->type == EVENT_TILT) host_accel_tilt(event->a, event->b);
+        else if (event->type == EVENT_ACCEL) host_accel_set(event->a, event->b, event->c);
+        else if (player.release_ticks == 0) click(now); // a click while the button is still down is lost
+    }
+}
+
+unsigned long host_script_get_clicks(void) {
+    return player.clicks;
+}
@@ -0,0 +1,65 @@
+/* hal_storage.c
+ * Host backend for storage.h: the blocks are a plain file (host_storage_set_file), one block after the
+ * other, written in place -- so the leaderboard lasts from one run of host/game to the next. Without a
+ * file they are kept in memory like on the Mango Pi, so runs stay repeatable (make host-golden).
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "storage.h"
+#include "hal.h"
+
+#define HOST_STORAGE_NBLOCKS 1024      // 512KB
+
+static struct {
+    const char *path;
+    FILE *file;
+    unsigned char blocks[HOST_STORAGE_NBLOCKS][STORAGE_BLOCK_SIZE];    // without a file
+    unsigned long writes;
+} storage;
+
+bool host_storage_set_file(const char *path) {
+    if (storage.file != NULL) fclose(storage.file);
+    storage.file = NULL;
+    storage.path = path;
+    return path == NULL || storage_init();
+}
+
+unsigned long host_storage_get_writes(void) {
+    return storage.writes;
+}
+
+bool storage_init(void) {
+    if (storage.path == NULL || storage.file != NULL) return true;
+    storage.file = fopen(storage.path, "r+b");
+    if (storage.file == NULL) storage.file = fopen(storage.path, "w+b");     // (a new, empty one)
+    return storage.file != NULL;
+}
+
+unsigned long storage_get_nblocks(void) {
+    return HOST_STORAGE_NBLOCKS;
+}
+
+bool storage_read(unsigned long block, void *buf) {
+    if (block >= HOST_STORAGE_NBLOCKS) return false;
+    if (storage.path == NULL) {
+        memcpy(buf, storage.blocks[block], STORAGE_BLOCK_SIZE);
+        return true;
+    }
+    if (!storage_init() || fseek(storage.file, (long)block * STORAGE_BLOCK_SIZE, SEEK_SET) != 0) return false;
+    size_t got = fread(buf, 1, STORAGE_BLOCK_SIZE, storage.file);
+    memset((unsigned char *)buf + got, 0, STORAGE_BLOCK_SIZE - got);    // past the end of the file: zeros
+    return true;
+}
+
+bool storage_write(unsigned long block, const void *buf) {
+    if (block >= HOST_STORAGE_NBLOCKS) return false;
+    storage.writes++;
+    if (storage.path == NULL) {
+        memcpy(storage.blocks[block], buf, STORAGE_BLOCK_SIZE);
+        return true;
+    }
+    if (!storage_init() || fseek(storage.file, (long)block * STORAGE_BLOCK_SIZE, SEEK_SET) != 0) return false;
+    if (fwrite(buf, 1, STORAGE_BLOCK_SIZE, storage.file) != STORAGE_BLOCK_SIZE) return false;
+    return fflush(storage.file) == 0;
+}
@@ -0,0 +1,55 @@
+/* hal_timer.c
+ * Host backend for the timer: a virtual clock in the Mango Pi's 24MHz ticks, starting at 0.
+ * Delays move the clock forward instead of waiting, and so does every timer_get_ticks() (by a small
+ * step), so the game's busy-wait loops still run out -- a game plays out the same on every run, and
+ * as fast as the host can go. Stand-in devices charge their own time (see hal_devices.c).
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "timer.h"
+#include "hal.h"
+
+#define DEFAULT_STEP TICKS_PER_USEC    // every read of the clock takes 1us
+
+static struct {
+    unsigned long ticks;
+    unsigned long step;
+    void (*hook)(unsigned long ticks);
+    bool in_hook;
+} vclock = { 0, DEFAULT_STEP, NULL, false };
+
+void host_timer_set_step(unsigned long ticks) {
+    vclock.step = ticks;
+}
+
+void host_timer_set_hook(void (*hook)(unsigned long ticks)) {
+    vclock.hook = hook;
+}
+
+unsigned long host_timer_now(void) {
+    return vclock.ticks;
+}
+
+// The hook may read the clock or drive devices whose handlers do; those don't re-enter it
+void host_timer_advance(unsigned long ticks) {
+    vclock.ticks += ticks;
+    if (vclock.hook == NULL || vclock.in_hook) return;
+    vclock.in_hook = true;
+    vclock.hook(vclock.ticks);
+    vclock.in_hook = false;
+}
+
+void timer_init(void) {}
+
+unsigned long timer_get_ticks(void) {
+    host_timer_advance(vclock.step);
+    return vclock.ticks;
+}
+
+void timer_delay_us(int usec) {
+    if (usec > 0) host_timer_advance((unsigned long)usec * TICKS_PER_USEC);
+}
+
+void timer_delay_ms(int msec) { timer_delay_us(msec * 1000); }
+void timer_delay(int sec) { timer_delay_us(sec * 1000000); }
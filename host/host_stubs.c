@@ -0,0 +1,73 @@
+/* host_stubs.c
+ * Linux host versions of the Mango Pi peripherals the game engine touches, so game_update.c,
+ * random_bag.c, input_log.c and replay.c build unchanged with gcc (see `make host`).
+ * Drawing, sound and the remote do nothing; time is the host's monotonic clock in 24MHz ticks.
+ */
+
+#include <stdio.h>
+#include <time.h>
+#include "gl.h"
+#include "fb.h"
+#include "font.h"
+#include "timer.h"
+#include "uart.h"
+#include "remote.h"
+#include "passive_buzz_intr.h"
+#include "LSD6DS33.h"
+
+// gl: replays on the host run headless, so nothing is ever drawn
+void gl_init(int width, int height, gl_mode_t mode) {}
+void gl_swap_buffer(void) {}
+void gl_clear(color_t c) {}
+void gl_draw_rect(int x, int y, int w, int h, color_t c) {}
+void gl_draw_line(int x1, int y1, int x2, int y2, color_t c) {}
+void gl_draw_string(int x, int y, const char *str, color_t c) {}
+int gl_get_char_height(void) { return 16; }
+int gl_get_char_width(void) { return 14; }
+int gl_get_width(void) { return 0; }
+int gl_get_height(void) { return 0; }
+int fb_get_width(void) { return 0; }
+int fb_get_height(void) { return 0; }
+int fb_get_depth(void) { return 4; }
+void *fb_get_draw_buffer(void) { return NULL; }
+int font_get_glyph_height(void) { return 16; }
+int font_get_glyph_width(void) { return 14; }
+int font_get_glyph_size(void) { return 14 * 16; }
+bool font_get_glyph(char ch, unsigned char buf[], size_t buflen) { return false; }
+
+// timer
+void timer_init(void) {}
+
+unsigned long timer_get_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000UL * TICKS_PER_USEC + ts.tv_nsec * TICKS_PER_USEC / 1000;
+}
+
+void timer_delay_us(int usec) {
+    unsigned long until = timer_get_ticks() + (unsigned long)usec * TICKS_PER_USEC;
+    while (timer_get_ticks() < until) ;
+}
+
+void timer_delay_ms(int msec) { timer_delay_us(msec * 1000); }
+void timer_delay(int sec) { timer_delay_us(sec * 1000000); }
+
+// uart: stdin/stdout
+void uart_init(void) {}
+int uart_getchar(void) { return getchar(); }
+int uart_putchar(int ch) { return putchar(ch); }
+bool uart_haschar(void) { return false; }
+
+// remote: held tilted down (so startGame doesn't wait), never pressed
+bool remote_is_button_press(void) { return false; }
+void remote_vibrate(int duration_sec) {}
+void remote_get_x_y_status(int *x, int *y) { *x = X_FAST; *y = HOME; }
+
+// buzzer: silent
+static int tempo = TEMPO_DEFAULT;
+void buzzer_intr_set_tempo(int tempo_) { tempo = tempo_; }
+int buzzer_intr_get_tempo(void) { return tempo; }
+void buzzer_intr_pause(void) {}
+void buzzer_intr_play(void) {}
+bool buzzer_intr_is_playing(void) { return false; }
+void buzzer_intr_play_effect(int effect) {}
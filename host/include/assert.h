@@ -0,0 +1,4 @@
+/* host/include/assert.h
+ * libmango's assert stops the program like the C library's
+ */
+#include <assert.h>
@@ -0,0 +1,13 @@
+/* host/include/console.h
+ * Linux host stand-in for the libmango console module
+ */
+#ifndef CONSOLE_H
+#define CONSOLE_H
+
+#include "gl.h"
+
+void console_init(int nrows, int ncols, color_t foreground, color_t background);
+void console_clear(void);
+int console_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+
+#endif
@@ -0,0 +1,17 @@
+/* host/include/fb.h
+ * Linux host stand-in for the libmango fb module: host/hal_gl.c's in-memory framebuffer (32-bit pixels,
+ * rows packed width apart). host/host_stubs.c has no framebuffer (fb_get_draw_buffer returns NULL)
+ */
+#ifndef FB_H
+#define FB_H
+
+typedef enum { FB_SINGLEBUFFER = 0, FB_DOUBLEBUFFER = 1 } fb_mode_t;
+
+void fb_init(int width, int height, fb_mode_t mode);
+int fb_get_width(void);
+int fb_get_height(void);
+int fb_get_depth(void);
+void *fb_get_draw_buffer(void);
+void fb_swap_buffer(void);
+
+#endif
@@ -0,0 +1,17 @@
+/* host/include/font.h
+ * Linux host stand-in for the libmango font module: glyphs one byte per pixel (0xff where the
+ * character has a pixel, 0 elsewhere), the size of a gl character cell. host/hal_gl.c's gl_draw_char
+ * draws these
+ */
+#ifndef FONT_H
+#define FONT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+int font_get_glyph_height(void);
+int font_get_glyph_width(void);
+int font_get_glyph_size(void);
+bool font_get_glyph(char ch, unsigned char buf[], size_t buflen);
+
+#endif
@@ -0,0 +1,44 @@
+/* host/include/gl.h
+ * Linux host stand-in for the libmango gl module (same names and colors). host/hal_gl.c draws into an
+ * in-memory framebuffer (see host/hal.h to read or dump it); host/host_stubs.c draws nothing
+ */
+#ifndef GL_H
+#define GL_H
+
+typedef unsigned int color_t;
+
+typedef enum { GL_SINGLEBUFFER = 0, GL_DOUBLEBUFFER = 1 } gl_mode_t;
+
+#define GL_BLACK    0xFF000000
+#define GL_WHITE    0xFFFFFFFF
+#define GL_RED      0xFFFF0000
+#define GL_GREEN    0xFF00FF00
+#define GL_BLUE     0xFF0000FF
+#define GL_CYAN     0xFF00FFFF
+#define GL_MAGENTA  0xFFFF00FF
+#define GL_YELLOW   0xFFFFFF00
+#define GL_AMBER    0xFFFFBF00
+#define GL_ORANGE   0xFFFF3F00
+#define GL_PURPLE   0xFF7F00FF
+#define GL_INDIGO   0xFF000040
+#define GL_CAYENNE  0xFF880000
+#define GL_MOSS     0xFF008800
+#define GL_SILVER   0xFFBBBBBB
+#define GL_OFFWHITE 0xFFEEEEEE
+
+void gl_init(int width, int height, gl_mode_t mode);
+int gl_get_width(void);
+int gl_get_height(void);
+color_t gl_color(unsigned char r, unsigned char g, unsigned char b);
+void gl_swap_buffer(void);
+void gl_clear(color_t c);
+void gl_draw_pixel(int x, int y, color_t c);
+color_t gl_read_pixel(int x, int y);
+void gl_draw_rect(int x, int y, int w, int h, color_t c);
+void gl_draw_line(int x1, int y1, int x2, int y2, color_t c);
+void gl_draw_char(int x, int y, char ch, color_t c);
+void gl_draw_string(int x, int y, const char *str, color_t c);
+int gl_get_char_height(void);
+int gl_get_char_width(void);
+
+#endif
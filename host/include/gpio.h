@@ -0,0 +1,28 @@
+/* host/include/gpio.h
+ * Linux host stand-in for the libmango gpio module; host/hal_gpio.c keeps every pin's level in memory
+ */
+#ifndef GPIO_H
+#define GPIO_H
+
+// pin ids are (group << 8) | pin number, as in libmango (only the pins the game uses are named)
+typedef enum {
+    GPIO_PB0 = 0x100, GPIO_PB1 = 0x101, GPIO_PB6 = 0x106, GPIO_PB7 = 0x107,
+    GPIO_PG13 = 0x60d,
+    GPIO_INVALID = 0xffff,
+} gpio_id_t;
+
+enum {
+    GPIO_FN_INPUT = 0,
+    GPIO_FN_OUTPUT = 1,
+    GPIO_FN_DISABLED = 15,
+};
+
+void gpio_init(void);
+void gpio_set_function(gpio_id_t pin, unsigned int function);
+unsigned int gpio_get_function(gpio_id_t pin);
+void gpio_set_input(gpio_id_t pin);
+void gpio_set_output(gpio_id_t pin);
+void gpio_write(gpio_id_t pin, int val);
+int gpio_read(gpio_id_t pin);
+
+#endif
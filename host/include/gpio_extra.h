@@ -0,0 +1,13 @@
+/* host/include/gpio_extra.h
+ * Linux host stand-in for the libmango gpio_extra module (pull-ups are remembered but change nothing)
+ */
+#ifndef GPIO_EXTRA_H
+#define GPIO_EXTRA_H
+
+#include "gpio.h"
+
+void gpio_set_pullup(gpio_id_t pin);
+void gpio_set_pulldown(gpio_id_t pin);
+void gpio_set_pullnone(gpio_id_t pin);
+
+#endif
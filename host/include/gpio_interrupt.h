@@ -0,0 +1,26 @@
+/* host/include/gpio_interrupt.h
+ * Linux host stand-in for the libmango gpio_interrupt module; see host/hal_gpio.c
+ */
+#ifndef GPIO_INTERRUPT_H
+#define GPIO_INTERRUPT_H
+
+#include <stdbool.h>
+#include "gpio.h"
+#include "interrupts.h"
+
+typedef enum {
+    GPIO_INTERRUPT_POSITIVE_EDGE = 0,
+    GPIO_INTERRUPT_NEGATIVE_EDGE = 1,
+    GPIO_INTERRUPT_HIGH_LEVEL = 2,
+    GPIO_INTERRUPT_LOW_LEVEL = 3,
+    GPIO_INTERRUPT_DOUBLE_EDGE = 4,
+} gpio_event_t;
+
+void gpio_interrupt_init(void);
+void gpio_interrupt_config(gpio_id_t pin, gpio_event_t event, bool debounce);
+void gpio_interrupt_register_handler(gpio_id_t pin, handlerfn_t fn, void *aux_data);
+void gpio_interrupt_enable(gpio_id_t pin);
+void gpio_interrupt_disable(gpio_id_t pin);
+void gpio_interrupt_clear(gpio_id_t pin);
+
+#endif
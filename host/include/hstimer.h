@@ -0,0 +1,14 @@
+/* host/include/hstimer.h
+ * Linux host stand-in for the libmango hstimer module (the host build's buzzer doesn't use timers)
+ */
+#ifndef HSTIMER_H
+#define HSTIMER_H
+
+typedef enum { HSTIMER0 = 0, HSTIMER1 } hstimer_id_t;
+
+void hstimer_init(hstimer_id_t index, long usecs);
+void hstimer_enable(hstimer_id_t index);
+void hstimer_disable(hstimer_id_t index);
+void hstimer_interrupt_clear(hstimer_id_t index);
+
+#endif
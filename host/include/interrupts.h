@@ -0,0 +1,27 @@
+/* host/include/interrupts.h
+ * Linux host stand-in for the libmango interrupts module. Nothing interrupts the host program
+ * asynchronously: host/hal_gpio.c calls registered handlers when a stand-in device raises one
+ */
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    INTERRUPT_SOURCE_HSTIMER0 = 71,
+    INTERRUPT_SOURCE_HSTIMER1 = 72,
+    INTERRUPT_SOURCE_GPIOB = 85,
+    INTERRUPT_SOURCE_GPIOG = 95,
+} interrupt_source_t;
+
+typedef void (*handlerfn_t)(uintptr_t pc, void *aux_data);
+
+void interrupts_init(void);
+void interrupts_global_enable(void);
+void interrupts_global_disable(void);
+bool interrupts_enable_source(interrupt_source_t source);
+bool interrupts_disable_source(interrupt_source_t source);
+void interrupts_register_handler(interrupt_source_t source, handlerfn_t fn, void *aux_data);
+
+#endif
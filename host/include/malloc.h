@@ -0,0 +1,4 @@
+/* host/include/malloc.h
+ * libmango's malloc/free are the C library's on the host
+ */
+#include <stdlib.h>
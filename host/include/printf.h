@@ -0,0 +1,4 @@
+/* host/include/printf.h
+ * libmango's printf family has the same signatures as the C library's
+ */
+#include <stdio.h>
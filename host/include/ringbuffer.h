@@ -0,0 +1,16 @@
+/* host/include/ringbuffer.h
+ * Linux host stand-in for the libmango ringbuffer module
+ */
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <stdbool.h>
+
+typedef struct ringbuffer rb_t;
+
+rb_t *rb_new(void);
+bool rb_empty(rb_t *rb);
+bool rb_enqueue(rb_t *rb, int elem);
+bool rb_dequeue(rb_t *rb, int *p_elem);
+
+#endif
@@ -0,0 +1,4 @@
+/* host/include/strings.h
+ * libmango's string functions are a subset of the C library's
+ */
+#include <string.h>
@@ -0,0 +1,15 @@
+/* host/include/timer.h
+ * Linux host stand-in for the libmango timer module: ticks count at the Mango Pi's 24MHz
+ */
+#ifndef TIMER_H
+#define TIMER_H
+
+#define TICKS_PER_USEC 24
+
+void timer_init(void);
+unsigned long timer_get_ticks(void);
+void timer_delay_us(int usec);
+void timer_delay_ms(int msec);
+void timer_delay(int sec);
+
+#endif
@@ -0,0 +1,14 @@
+/* host/include/uart.h
+ * Linux host stand-in for the libmango uart module: stdin/stdout
+ */
+#ifndef UART_H
+#define UART_H
+
+#include <stdbool.h>
+
+void uart_init(void);
+int uart_getchar(void);
+int uart_putchar(int ch);
+bool uart_haschar(void);
+
+#endif
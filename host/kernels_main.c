@@ -0,0 +1,35 @@
+/* kernels_main.c
+ * Pixel kernels on the computer: checks pixel_fill & co. against their scalar versions, then times them.
+ * Built natively (host/kernels) it's the scalar path both times; built for RISC-V with the vector
+ * extension and run under qemu (make kernels-qemu) it checks and times the RVV kernels. Under qemu the
+ * cycle counts only show instructions retired, not what the C906 would take: time them on the board
+ * with test_pixel_kernels.
+ *
+ * Usage: host/kernels [reps]
+ * Exits 1 if any kernel's pixels differ from its scalar version's.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "pixel_kernels.h"
+
+#define WIDTH 200
+#define HEIGHT 400
+
+int main(int argc, char *argv[]) {
+    int reps = (argc > 1) ? atoi(argv[1]) : 200;
+    color_t *a = malloc(WIDTH * HEIGHT * sizeof(color_t));
+    color_t *b = malloc(WIDTH * HEIGHT * sizeof(color_t));
+    if (a == NULL || b == NULL || reps <= 0) {
+        fprintf(stderr, "usage: %s [reps]\n", argv[0]);
+        return 2;
+    }
+
+    int mismatches = pixel_kernels_check(a, b);
+    printf("pixel kernels (%s): %d mismatches\n", PIXEL_KERNELS_IMPL, mismatches);
+    if (!PIXEL_KERNELS_RVV) printf("(scalar build: that compared the scalar kernels with themselves -- make kernels-qemu checks the vector ones)\n");
+    if (mismatches == 0) pixel_kernels_bench(a, b, WIDTH, HEIGHT, reps);
+    free(a);
+    free(b);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+/* leaderboard_main.c
+ * The all-time leaderboard (leaderboard.c) on the computer: checks it against a plain sorted array
+ * (same ranks, same pages, same best entries, the board full or not), then times adding entries,
+ * rank lookups, pages and best lookups as the board fills up. The tree's times should stay flat from
+ * 1000 entries to 10000; the sorted array's inserts (a binary search, then shifting everything below)
+ * grow with the board.
+ *
+ * Usage: host/leaderboard [entries]   (default: the board's capacity and a half, so it overflows)
+ * Exits 1 if the board and the array ever disagree.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "leaderboard.h"
+
+#define STEP 1000       // entries added between timings
+#define QUERIES 20000   // lookups per timing
+#define PAGE 10
+
+typedef struct {
+    leaderboard_record_t record;
+    unsigned int order;
+} entry_t;
+
+// the reference: entries in rank order, found by binary search and inserted by shifting
+static entry_t sorted[LEADERBOARD_MAX_ENTRIES + 1];
+static int nsorted;
+
+static bool above(const entry_t *a, const entry_t *b) {
+    return a->record.score != b->record.score ? a->record.score > b->record.score : a->order > b->order;
+}
+
+static int sorted_add(const leaderboard_record_t *record, unsigned int order) {
+    entry_t e = { *record, order };
+    int lo = 0, hi = nsorted;   // first position whose entry ranks below e
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (above(&sorted[mid], &e)) lo = mid + 1;
+        else hi = mid;
+    }
+    if (nsorted == LEADERBOARD_MAX_ENTRIES) {
+        if (lo == nsorted) return 0;
+        nsorted--;  // the lowest goes
+    }
+    memmove(&sorted[lo + 1], &sorted[lo], (nsorted - lo) * sizeof(entry_t));
+    sorted[lo] = e;
+    nsorted++;
+    return lo + 1;
+}
+
+static uint32_t rng = 12345;
+
+static uint32_t next_random(void) {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static leaderboard_record_t random_record(unsigned int i) {
+    // scores like the game's (multiples of 40, clumped, lots of ties), initials from a few hundred players
+    unsigned int player = next_random() % 400;
+    leaderboard_record_t record = { { 'A' + player % 26, 'A' + player / 26 }, (next_random() % 500) * 40, next_random() % 200, i };
+    return record;
+}
+
+static double now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec / 1e9;
+}
+
+static int check(const leaderboard_t *board) {
+    static leaderboard_record_t page[LEADERBOARD_MAX_ENTRIES];
+    int errors = 0;
+    if (leaderboard_get_count(board) != nsorted) errors++;
+    int n = leaderboard_get_page(board, 1, page, LEADERBOARD_MAX_ENTRIES);
+    if (n != nsorted) errors++;
+    for (int i = 0; i < n && i < nsorted; i++) {
+        const leaderboard_record_t *a = &page[i], *b = &sorted[i].record;
+        if (a->initials[0] != b->initials[0] || a->initials[1] != b->initials[1] || a->score != b->score ||
+            a->lines != b->lines || a->time != b->time) errors++;
+    }
+    // each player's best is their first entry in rank order
+    static bool seen[26][26];
+    memset(seen, 0, sizeof(seen));
+    for (int i = 0; i < nsorted; i++) {
+        const char *initials = sorted[i].record.initials;
+        if (seen[initials[0] - 'A'][initials[1] - 'A']) continue;
+        seen[initials[0] - 'A'][initials[1] - 'A'] = true;
+        leaderboard_record_t best;
+        int rank;
+        if (!leaderboard_get_best(board, initials, &best, &rank) || rank != i + 1) errors++;
+    }
+    return errors;
+}
+
+int main(int argc, char *argv[]) {
+    int total = (argc > 1) ? atoi(argv[1]) : LEADERBOARD_MAX_ENTRIES * 3 / 2;
+    if (total <= 0) {
+        fprintf(stderr, "usage: %s [entries]\n", argv[0]);
+        return 2;
+    }
+    static leaderboard_t board;
+    leaderboard_init(&board);
+
+    // check: every rank as it's added, the whole board every STEP entries
+    int errors = 0;
+    for (int i = 0; i < total; i++) {
+        leaderboard_record_t record = random_record(i);
+        int expected_rank = leaderboard_get_rank(&board, record.score);
+        int rank = leaderboard_add(&board, &record);
+        if (rank != sorted_add(&record, i) || (rank != 0 && rank != expected_rank)) errors++;
+        if ((i + 1) % STEP == 0 || i + 1 == total) errors += check(&board);
+    }
+    printf("leaderboard: %d entries added, %d kept, %d mismatches\n", total, leaderboard_get_count(&board), errors);
+    if (errors != 0) return 1;
+
+    // timing, as the board fills up (ns per call)
+    printf("%8s %10s %10s %10s %10s %14s\n", "entries", "add", "rank", "page(10)", "best", "sorted add");
+    leaderboard_init(&board);
+    nsorted = 0;
+    static leaderboard_record_t records[STEP], page[PAGE];
+    unsigned int order = 0;
+    for (int size = STEP; size <= total; size += STEP) {
+        for (int i = 0; i < STEP; i++) records[i] = random_record(order + i);
+
+        double t0 = now();
+        for (int i = 0; i < STEP; i++) leaderboard_add(&board, &records[i]);
+        double t1 = now();
+        for (int i = 0; i < STEP; i++) sorted_add(&records[i], order + i);
+        double t2 = now();
+        order += STEP;
+
+        volatile int sink = 0;
+        double t3 = now();
+        for (int i = 0; i < QUERIES; i++) sink += leaderboard_get_rank(&board, (next_random() % 500) * 40);
+        double t4 = now();
+        for (int i = 0; i < QUERIES; i++) sink += leaderboard_get_page(&board, 1 + next_random() % leaderboard_get_count(&board), page, PAGE);
+        double t5 = now();
+        for (int i = 0; i < QUERIES; i++) {
+            int rank = 0;
+            leaderboard_get_best(&board, records[i % STEP].initials, &page[0], &rank);
+            sink += rank;
+        }
+        double t6 = now();
+        printf("%8d %10.0f %10.0f %10.0f %10.0f %14.0f\n", leaderboard_get_count(&board), (t1 - t0) * 1e9 / STEP,
+               (t4 - t3) * 1e9 / QUERIES, (t5 - t4) * 1e9 / QUERIES, (t6 - t5) * 1e9 / QUERIES, (t2 - t1) * 1e9 / STEP);
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+/* replay_main.c
+ * Replays input logs recorded on the Mango Pi (input_log.h) on a Linux computer, as fast as possible,
+ * so the same game can be benchmarked over and over and compared between builds.
+ *
+ * Usage: host/replay [-n repeats] log...
+ * Each log is either a binary log file or saved uart output containing an input_log_dump
+ * (INPUTLOG ... END block; the last one in the file is used).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input_log.h"
+#include "replay.h"
+#include "timer.h"
+
+static unsigned char buf[INPUT_LOG_MAX_BYTES];
+static game_t game;
+
+// Reads the last INPUTLOG ... END hex block of a uart capture into buf
+static size_t read_dump(FILE *f) {
+    char line[256];
+    size_t len = 0;
+    int inside = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (strncmp(line, "INPUTLOG", 8) == 0) {
+            inside = 1;
+            len = 0;
+        } else if (strncmp(line, "END", 3) == 0) {
+            inside = 0;
+        } else if (inside) {
+            for (char *p = line; p[0] && p[1] && len < sizeof(buf); p += 2) {
+                unsigned int byte;
+                if (sscanf(p, "%2x", &byte) != 1) break;
+                buf[len++] = byte;
+            }
+        }
+    }
+    return len;
+}
+
+static size_t read_log(const char *path) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        perror(path);
+        return 0;
+    }
+    size_t len = fread(buf, 1, sizeof(buf), f);
+    if (len < 4 || memcmp(buf, "TLOG", 4) != 0) {
+        rewind(f);
+        len = read_dump(f);
+    }
+    fclose(f);
+    return len;
+}
+
+int main(int argc, char *argv[]) {
+    int repeats = 1;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-n") == 0) {
+        repeats = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || repeats < 1) {
+        fprintf(stderr, "usage: %s [-n repeats] log...\n", argv[0]);
+        return 2;
+    }
+
+    int status = 0;
+    for (int i = first; i < argc; i++) {
+        input_log_t log;
+        size_t len = read_log(argv[i]);
+        if (!input_log_parse(&log, buf, len)) {
+            fprintf(stderr, "%s: not an input log\n", argv[i]);
+            status = 1;
+            continue;
+        }
+        replay_result_t result;
+        unsigned long best = 0;
+        bool complete = true;
+        for (int r = 0; r < repeats; r++) {
+            complete = replay_run(&game, &log, REPLAY_FAST, &result) && complete;
+            if (r == 0 || result.ticks < best) best = result.ticks;
+        }
+        double secs = best / (1e6 * TICKS_PER_USEC);
+        printf("%s: seed %u, %zu bytes, %lu commands, %d pieces -> score %d, lines %d%s\n",
+               argv[i], (unsigned int)log.seed, len, result.commands, result.pieces,
+               result.score, result.lines, result.game_over ? ", game over" : "");
+        printf("  best of %d: %.3f ms (%.0f commands/s, %.0f pieces/s)%s\n", repeats, secs * 1e3,
+               result.commands / secs, result.pieces / secs, complete ? "" : "  ** diverged **");
+        if (!complete) status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,122 @@
+/* sim_main.c
+ * Soak test / throughput benchmark: plays many headless games at once, spread over worker threads.
+ * Every game has its own game_t (board, bag, score), so the threads share nothing but the
+ * read-only piece tables, and throughput should scale with the number of cores.
+ *
+ * Usage: host/sim [-g games] [-t threads] [-s first_seed] [-p max_pieces_per_game]
+ * Game k uses seed first_seed + k and its own move generator seeded from that, so the totals
+ * (and the checksum) are the same whatever the number of threads -- compare them across builds.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "game_update.h"
+
+#define NROWS 20
+#define NCOLS 10
+
+static struct {
+    int ngames;
+    int nthreads;
+    uint32_t first_seed;
+    int max_pieces;
+} config = { 1000, 4, 1, 100000 };
+
+typedef struct {
+    int id;
+    pthread_t thread;
+    game_t game;
+    unsigned long games, pieces, lines, commands;
+    unsigned long checksum;     // sum over games of score * (game index + 1)
+} __attribute__((aligned(64))) worker_t;
+
+// xorshift32: each game's moves come from its own generator
+static uint32_t next_rand(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *state = x;
+}
+
+// Plays one game: every piece gets a random rotation and sideways shift (sometimes a swap),
+// then is dropped and locked. Returns the number of pieces placed
+static int play_game(game_t *game, uint32_t seed, unsigned long *commands) {
+    uint32_t rand_state = seed * 2654435761u + 1;
+    game_update_init_seeded(game, NROWS, NCOLS, seed);
+    falling_piece_t piece = init_falling_piece(game);
+    int pieces = 0;
+    while (!game_update_is_game_over(game) && pieces < config.max_pieces) {
+        uint32_t r = next_rand(&rand_state);
+        if (r % 8 == 0) { swap(game, &piece); (*commands)++; }
+        for (int k = 0; k < (r >> 3) % 4; k++, (*commands)++) rotate(game, &piece);
+        int shift = (int)((r >> 5) % 11) - 5;
+        for (int k = 0; k < abs(shift); k++, (*commands)++) {
+            if (shift < 0) move_left(game, &piece);
+            else move_right(game, &piece);
+        }
+        while (!lock_piece(game, &piece)) { move_down(game, &piece); (*commands)++; } // hard drop
+        (*commands)++;
+        pieces++;
+    }
+    return pieces;
+}
+
+static void *run_worker(void *arg) {
+    worker_t *w = arg;
+    game_update_set_headless(&w->game, true);
+    for (int k = w->id; k < config.ngames; k += config.nthreads) {
+        w->pieces += play_game(&w->game, config.first_seed + k, &w->commands);
+        w->lines += game_update_get_rows_cleared(&w->game);
+        w->checksum += (unsigned long)game_update_get_score(&w->game) * (k + 1);
+        w->games++;
+    }
+    return NULL;
+}
+
+static double now_secs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[]) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "-g") == 0) config.ngames = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0) config.nthreads = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-s") == 0) config.first_seed = strtoul(argv[i + 1], NULL, 0);
+        else if (strcmp(argv[i], "-p") == 0) config.max_pieces = atoi(argv[i + 1]);
+        else break;
+    }
+    if (argc % 2 == 0 || config.ngames < 1 || config.nthreads < 1 || config.max_pieces < 1) {
+        fprintf(stderr, "usage: %s [-g games] [-t threads] [-s first_seed] [-p max_pieces_per_game]\n", argv[0]);
+        return 2;
+    }
+
+    worker_t *workers;
+    if (posix_memalign((void **)&workers, 64, config.nthreads * sizeof(worker_t)) != 0) return 1;
+    memset(workers, 0, config.nthreads * sizeof(worker_t));
+    double start = now_secs();
+    for (int t = 0; t < config.nthreads; t++) {
+        workers[t].id = t;
+        pthread_create(&workers[t].thread, NULL, run_worker, &workers[t]);
+    }
+    unsigned long games = 0, pieces = 0, lines = 0, commands = 0, checksum = 0;
+    for (int t = 0; t < config.nthreads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        games += workers[t].games;
+        pieces += workers[t].pieces;
+        lines += workers[t].lines;
+        commands += workers[t].commands;
+        checksum += workers[t].checksum;
+    }
+    double secs = now_secs() - start;
+
+    printf("%lu games, %lu pieces, %lu lines, %lu commands on %d threads in %.3f s\n",
+           games, pieces, lines, commands, config.nthreads, secs);
+    printf("%.0f games/s, %.0f pieces/s, %.0f commands/s (checksum %lu)\n",
+           games / secs, pieces / secs, commands / secs, checksum);
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,106 @@
+/* input_log.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The input_log.c module records a compact log of a game (random bag seed + timestamped engine commands)
+* and reads it back for replays. Format is described in input_log.h.
+*/
+
+#include "input_log.h"
+#include "timer.h"
+#include "printf.h"
+#include "strings.h"
+
+static const char LOG_MAGIC[4] = { 'T', 'L', 'O', 'G' };
+
+static unsigned long now_ms(void) {
+    return timer_get_ticks() / (1000 * TICKS_PER_USEC);
+}
+
+// Begins a new log (called from game_update_init_seeded); the previous log is discarded
+void input_log_start(input_recorder_t *rec, int nrows, int ncols, uint32_t seed) {
+    memcpy(rec->buf, LOG_MAGIC, sizeof(LOG_MAGIC));
+    rec->buf[4] = INPUT_LOG_VERSION;
+    rec->buf[5] = nrows;
+    rec->buf[6] = ncols;
+    rec->buf[7] = 0;
+    for (int i = 0; i < 4; i++) rec->buf[8 + i] = (seed >> (8 * i)) & 0xff;
+    rec->len = INPUT_LOG_HEADER_SIZE;
+    rec->last_ms = now_ms();
+    rec->truncated = false;
+}
+
+// Appends one command as a varint of (delta ms << 3 | cmd). A command that doesn't fit is dropped
+// and the log is flagged truncated, since replaying past a missing command would diverge anyway
+void input_log_record(input_recorder_t *rec, game_cmd_t cmd) {
+    if (rec->truncated || rec->len == 0) return;
+    unsigned long now = now_ms();
+    unsigned long value = ((now - rec->last_ms) << INPUT_LOG_CMD_BITS) | cmd;
+    rec->last_ms = now;
+
+    unsigned char bytes[10];
+    size_t n = 0;
+    do {
+        bytes[n] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) bytes[n] |= 0x80;
+        n++;
+    } while (value != 0);
+
+    if (rec->len + n > sizeof(rec->buf)) {
+        rec->truncated = true;
+        return;
+    }
+    memcpy(rec->buf + rec->len, bytes, n);
+    rec->len += n;
+}
+
+bool input_log_is_truncated(const input_recorder_t *rec) {
+    return rec->truncated;
+}
+
+const unsigned char *input_log_get(const input_recorder_t *rec, size_t *len) {
+    *len = rec->len;
+    return rec->buf;
+}
+
+// 32 bytes (64 hex digits) per line
+void input_log_dump(const input_recorder_t *rec) {
+    printf("\nINPUTLOG %d\n", (int)rec->len);
+    for (size_t i = 0; i < rec->len; i++) {
+        printf("%02x", rec->buf[i]);
+        if (i % 32 == 31 || i == rec->len - 1) printf("\n");
+    }
+    printf("END\n");
+}
+
+bool input_log_parse(input_log_t *log, const unsigned char *buf, size_t len) {
+    if (len < INPUT_LOG_HEADER_SIZE) return false;
+    for (int i = 0; i < sizeof(LOG_MAGIC); i++) {
+        if (buf[i] != LOG_MAGIC[i]) return false;
+    }
+    if (buf[4] != INPUT_LOG_VERSION) return false;
+    log->nrows = buf[5];
+    log->ncols = buf[6];
+    log->seed = buf[8] | (buf[9] << 8) | (buf[10] << 16) | ((uint32_t)buf[11] << 24);
+    log->events = buf + INPUT_LOG_HEADER_SIZE;
+    log->len = len - INPUT_LOG_HEADER_SIZE;
+    return log->nrows > 0 && log->ncols > 0 && log->nrows <= GAME_MAX_ROWS && log->ncols <= GAME_MAX_COLS;
+}
+
+bool input_log_next(const input_log_t *log, size_t *pos, game_cmd_t *cmd, unsigned long *delta_ms) {
+    unsigned long value = 0;
+    int shift = 0;
+    while (*pos < log->len) {
+        unsigned char byte = log->events[(*pos)++];
+        value |= (unsigned long)(byte & 0x7f) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            *cmd = value & ((1 << INPUT_LOG_CMD_BITS) - 1);
+            *delta_ms = value >> INPUT_LOG_CMD_BITS;
+            return *cmd < GAME_CMD_COUNT;
+        }
+        if (shift >= 63) return false;
+    }
+    return false;  // end of log (or an event cut off mid-varint)
+}
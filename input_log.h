@@ -0,0 +1,53 @@
+#ifndef _INPUT_LOG_H
+#define _INPUT_LOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "game_update.h"
+
+// Binary input log of one game: the random bag seed plus every engine command that changed the game,
+// so replay.c can play the exact same game again (on the Mango Pi or on a computer).
+//
+// Header (12 bytes): "TLOG", version, nrows, ncols, reserved, seed (u32, little-endian)
+// Events: one varint per command = (ms since the previous command << 3) | game_cmd_t
+//         (7 bits per byte, low bits first, top bit set on every byte but the last)
+// Commands less than 16ms apart take 1 byte, less than 2s apart take 2 bytes.
+
+#define INPUT_LOG_VERSION 1
+#define INPUT_LOG_HEADER_SIZE 12
+#define INPUT_LOG_MAX_BYTES 16384   // ~8000 commands; recording stops (and is flagged truncated) when full
+#define INPUT_LOG_CMD_BITS 3
+
+// A log being recorded. Each game records into its own recorder (see game_update_set_recorder)
+typedef struct input_recorder {
+    unsigned char buf[INPUT_LOG_MAX_BYTES];
+    size_t len;
+    unsigned long last_ms;  // time of the previous command
+    bool truncated;
+} input_recorder_t;
+
+typedef struct {
+    const unsigned char *events;
+    size_t len;         // bytes of events
+    int nrows;
+    int ncols;
+    uint32_t seed;
+} input_log_t;
+
+// Recording (game_update.c calls these for the game's recorder)
+void input_log_start(input_recorder_t *rec, int nrows, int ncols, uint32_t seed);
+void input_log_record(input_recorder_t *rec, game_cmd_t cmd);
+bool input_log_is_truncated(const input_recorder_t *rec);
+
+// The log being recorded, ready for replay_run or to save
+const unsigned char *input_log_get(const input_recorder_t *rec, size_t *len);
+
+// Prints the log over uart as hex, between "INPUTLOG" and "END" lines (host/replay reads this)
+void input_log_dump(const input_recorder_t *rec);
+
+// Reading: parse checks the header; next decodes the event at *pos and advances it (false at the end)
+bool input_log_parse(input_log_t *log, const unsigned char *buf, size_t len);
+bool input_log_next(const input_log_t *log, size_t *pos, game_cmd_t *cmd, unsigned long *delta_ms);
+
+#endif
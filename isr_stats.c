@@ -0,0 +1,167 @@
+/* isr_stats.c
+ * Module to measure how much cpu time each interrupt handler takes (and how late timer interrupts run)
+ * Author: Aditi (aditijb@stanford.edu)
+ */
+
+#include "isr_stats.h"
+#include "gpio_interrupt.h"
+#include "cycle_count.h"
+#include "timer.h"
+#include "printf.h"
+#include "strings.h"
+#include <stddef.h>
+
+#define NO_SOURCE -1 // gpio handlers are dispatched by gpio_interrupt, not by their own source
+
+// the real handler and its aux_data, which have to change together
+typedef struct {
+    handlerfn_t fn ;
+    void *aux_data ;
+} isr_binding_t ;
+
+typedef struct {
+    isr_binding_t bindings[2] ;  // the one in use, and the one a new registration is written into
+    isr_binding_t *volatile handler ; // the one in use: registering again swaps it with one store
+    int source ;                 // NO_SOURCE for a gpio handler
+    int pin ;                    // the gpio handler's pin (NO_SOURCE for others)
+    bool armed ;                 // whether expected_ticks is valid for the next run
+    unsigned long expected_ticks ;
+    isr_stats_t stats ;
+} isr_slot_t ;
+
+static isr_slot_t slots[ISR_STATS_MAX_HANDLERS] ;
+static int nslots ;
+
+// `latency_bucket`
+// @returns histogram bucket for a latency in timer ticks (bucket i is < 2^i us)
+static int latency_bucket(unsigned long ticks) {
+    unsigned long usecs = ticks / TICKS_PER_USEC ;
+    int bucket = 0 ;
+    while (usecs > 0 && bucket < ISR_STATS_JITTER_BUCKETS - 1) {
+        usecs >>= 1 ;
+        bucket++ ;
+    }
+    return bucket ;
+}
+
+// `handle_wrapped`
+// registered in place of every wrapped handler: times the real handler's run
+static void handle_wrapped(uintptr_t pc, void *aux_data) {
+    unsigned long start = cycle_count_read() ;
+    isr_slot_t *slot = (isr_slot_t *)aux_data ;
+    isr_stats_t *stats = &slot->stats ;
+
+    if (slot->armed) {
+        unsigned long now = timer_get_ticks() ;
+        unsigned long late = (now > slot->expected_ticks) ? now - slot->expected_ticks : 0 ;
+        slot->armed = false ; // the handler may re-arm
+        stats->latency_samples++ ;
+        stats->jitter[latency_bucket(late)]++ ;
+        if (late > stats->max_latency_ticks) stats->max_latency_ticks = late ;
+    }
+
+    isr_binding_t *handler = slot->handler ;
+    handler->fn(pc, handler->aux_data) ;
+
+    unsigned long cycles = cycle_count_read() - start ;
+    stats->count++ ;
+    stats->total_cycles += cycles ;
+    if (cycles > stats->max_cycles) stats->max_cycles = cycles ;
+}
+
+// `new_slot`
+// @returns the slot for a handler: the one already used for its source (or gpio pin), since registering
+// again replaces that handler, or else a fresh one (NULL if all ISR_STATS_MAX_HANDLERS are used)
+// a slot already in use stays registered (handle_wrapped) while it's rewritten, and its interrupt may
+// fire meanwhile: the new fn and aux_data go in the spare binding, and one store of handler switches over
+static isr_slot_t *new_slot(handlerfn_t fn, void *aux_data, const char *name, int source, int pin) {
+    isr_slot_t *slot = NULL ;
+    for (int i = 0; i < nslots; i++) {
+        if (slots[i].source == source && slots[i].pin == pin) slot = &slots[i] ;
+    }
+    if (slot == NULL) {
+        if (nslots == ISR_STATS_MAX_HANDLERS) return NULL ;
+        slot = &slots[nslots] ;
+        memset(slot, 0, sizeof(*slot)) ;
+        slot->handler = &slot->bindings[0] ;
+        slot->source = source ;
+        slot->pin = pin ;
+        nslots++ ;
+    }
+    isr_binding_t *spare = (slot->handler == &slot->bindings[0]) ? &slot->bindings[1] : &slot->bindings[0] ;
+    spare->fn = fn ;
+    spare->aux_data = aux_data ;
+    __asm__ volatile ("" : : : "memory") ; // (both written before the switch)
+    slot->handler = spare ;
+    slot->armed = false ;
+    memset(&slot->stats, 0, sizeof(slot->stats)) ; // may tear if the handler runs mid-reset, as in isr_stats_reset
+    slot->stats.name = name ;
+    return slot ;
+}
+
+// 'isr_stats_register_handler'
+// falls back to registering fn unwrapped if there are no slots left, so the game still works
+void isr_stats_register_handler(interrupt_source_t source, handlerfn_t fn, void *aux_data, const char *name) {
+    isr_slot_t *slot = new_slot(fn, aux_data, name, source, NO_SOURCE) ;
+    if (slot == NULL) interrupts_register_handler(source, fn, aux_data) ;
+    else interrupts_register_handler(source, handle_wrapped, slot) ;
+}
+
+// 'isr_stats_register_gpio_handler'
+// same as above, for a single gpio pin's interrupt
+void isr_stats_register_gpio_handler(gpio_id_t pin, handlerfn_t fn, void *aux_data, const char *name) {
+    isr_slot_t *slot = new_slot(fn, aux_data, name, NO_SOURCE, pin) ;
+    if (slot == NULL) gpio_interrupt_register_handler(pin, fn, aux_data) ;
+    else gpio_interrupt_register_handler(pin, handle_wrapped, slot) ;
+}
+
+// 'isr_stats_arm'
+// called right after a timer is started
+void isr_stats_arm(interrupt_source_t source, long usecs) {
+    for (int i = 0; i < nslots; i++) {
+        if (slots[i].source == (int)source) {
+            slots[i].expected_ticks = timer_get_ticks() + usecs * TICKS_PER_USEC ;
+            slots[i].armed = true ;
+            return ;
+        }
+    }
+}
+
+// 'isr_stats_get'
+// looks the handler up by name
+bool isr_stats_get(const char *name, isr_stats_t *stats) {
+    for (int i = 0; i < nslots; i++) {
+        if (strcmp(slots[i].stats.name, name) == 0) {
+            *stats = slots[i].stats ; // may tear if the handler runs mid-copy; fine for a report
+            return true ;
+        }
+    }
+    return false ;
+}
+
+// 'isr_stats_reset'
+// zeroes the counters
+void isr_stats_reset(void) {
+    for (int i = 0; i < nslots; i++) {
+        const char *name = slots[i].stats.name ;
+        memset(&slots[i].stats, 0, sizeof(slots[i].stats)) ;
+        slots[i].stats.name = name ;
+    }
+}
+
+// 'isr_stats_report'
+// prints one line of cost per handler, then one line of latency histogram for timer handlers
+void isr_stats_report(void) {
+    printf("\nhandler       runs        avg cyc   max cyc   total cyc\n") ;
+    for (int i = 0; i < nslots; i++) {
+        isr_stats_t s = slots[i].stats ;
+        printf("%s\t%ld\t%ld\t%ld\t%ld\n", s.name, s.count, s.count ? s.total_cycles / s.count : 0, s.max_cycles, s.total_cycles) ;
+    }
+    for (int i = 0; i < nslots; i++) {
+        isr_stats_t s = slots[i].stats ;
+        if (s.latency_samples == 0) continue ;
+        printf("%s latency (max %ld us): <1us %ld", s.name, s.max_latency_ticks / TICKS_PER_USEC, s.jitter[0]) ;
+        for (int b = 1; b < ISR_STATS_JITTER_BUCKETS - 1; b++) printf(" <%dus %ld", 1 << b, s.jitter[b]) ;
+        printf(" >=%dus %ld\n", 1 << (ISR_STATS_JITTER_BUCKETS - 2), s.jitter[ISR_STATS_JITTER_BUCKETS - 1]) ;
+    }
+}
@@ -0,0 +1,72 @@
+/* isr_stats.h
+ * Module to measure how much cpu time each interrupt handler takes (and how late timer interrupts run)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * Register handlers through isr_stats_register_handler / isr_stats_register_gpio_handler instead of
+ * interrupts_register_handler / gpio_interrupt_register_handler. Every run of the handler is then
+ * timed with the cycle counter. Timer handlers can also call isr_stats_arm when they start their
+ * timer, so the next run records its entry latency (actual - expected fire time) in a histogram.
+ * Results: isr_stats_report prints everything over uart, isr_stats_get is the query API.
+ */
+
+#ifndef ISR_STATS_H
+#define ISR_STATS_H
+
+#include <stdbool.h>
+#include "interrupts.h"
+#include "gpio.h"
+
+#define ISR_STATS_MAX_HANDLERS 8
+
+// entry latency histogram: bucket 0 is < 1us late, bucket i is < 2^i us late, last bucket is everything later
+#define ISR_STATS_JITTER_BUCKETS 8
+
+typedef struct {
+    const char *name ;
+    unsigned long count ;          // number of runs
+    unsigned long total_cycles ;
+    unsigned long max_cycles ;     // most expensive single run
+    unsigned long latency_samples ;// runs that were armed with isr_stats_arm
+    unsigned long max_latency_ticks ;
+    unsigned long jitter[ISR_STATS_JITTER_BUCKETS] ;
+} isr_stats_t ;
+
+/* 'isr_stats_register_handler'
+ * @params interrupt_source_t source, handlerfn_t fn, void *aux_data - same as interrupts_register_handler
+ * @param const char *name - name used in the report and by isr_stats_get (string must stay around)
+ * @functionality - registers fn for source, wrapped so its runs are counted and timed
+ */
+void isr_stats_register_handler(interrupt_source_t source, handlerfn_t fn, void *aux_data, const char *name) ;
+
+/* 'isr_stats_register_gpio_handler'
+ * @params gpio_id_t pin, handlerfn_t fn, void *aux_data - same as gpio_interrupt_register_handler
+ * @param const char *name - name used in the report and by isr_stats_get
+ * @functionality - registers fn for pin's gpio interrupt, wrapped so its runs are counted and timed
+ */
+void isr_stats_register_gpio_handler(gpio_id_t pin, handlerfn_t fn, void *aux_data, const char *name) ;
+
+/* 'isr_stats_arm'
+ * @param interrupt_source_t source - timer interrupt source that was just started
+ * @param long usecs - timer interval it was started with
+ * @functionality - records when the next interrupt from source is due, so its entry latency gets measured
+ */
+void isr_stats_arm(interrupt_source_t source, long usecs) ;
+
+/* 'isr_stats_get'
+ * @param const char *name - name the handler was registered with
+ * @param isr_stats_t *stats - receives a copy of the handler's stats
+ * @return - false if no handler was registered with that name
+ */
+bool isr_stats_get(const char *name, isr_stats_t *stats) ;
+
+/* 'isr_stats_reset'
+ * @functionality - zeroes the stats of every handler (handlers stay registered)
+ */
+void isr_stats_reset(void) ;
+
+/* 'isr_stats_report'
+ * @functionality - prints a table of every handler's cost and latency histogram over uart
+ */
+void isr_stats_report(void) ;
+
+#endif
@@ -0,0 +1,149 @@
+/* leaderboard.c
+ * Module for the all-time leaderboard (see leaderboard.h)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * the tree is in rank order (left: higher ranks) and a heap on priority(node): every node's priority
+ * is at least its children's. priorities are a hash of the node's order, so the tree's shape is random
+ * (O(log n) deep on average) but the same every time the same entries are added
+ */
+
+#include "leaderboard.h"
+#include "strings.h"
+
+#define NODE(n) (board->nodes[n])
+#define SIZE(n) ((n) == 0 ? 0 : board->nodes[n].size)
+
+static unsigned int priority(const leaderboard_t *board, unsigned short n) {
+    unsigned int x = NODE(n).order * 0x9E3779B9u ; // (a few rounds of mixing)
+    x ^= x >> 16 ; x *= 0x85EBCA6Bu ; x ^= x >> 13 ; x *= 0xC2B2AE35u ; x ^= x >> 16 ;
+    return x ;
+}
+
+// true if node a ranks above node b
+static bool ranks_above(const leaderboard_t *board, unsigned short a, unsigned short b) {
+    if (NODE(a).record.score != NODE(b).record.score) return NODE(a).record.score > NODE(b).record.score ;
+    return NODE(a).order > NODE(b).order ;
+}
+
+static void update_size(leaderboard_t *board, unsigned short n) {
+    NODE(n).size = SIZE(NODE(n).left) + 1 + SIZE(NODE(n).right) ;
+}
+
+// splits tree t into the nodes that rank above key (*above) and the ones below it (*below)
+static void split(leaderboard_t *board, unsigned short t, unsigned short key, unsigned short *above, unsigned short *below) {
+    if (t == 0) { *above = *below = 0 ; return ; }
+    if (ranks_above(board, t, key)) {
+        split(board, NODE(t).right, key, &NODE(t).right, below) ;
+        *above = t ;
+    } else {
+        split(board, NODE(t).left, key, above, &NODE(t).left) ;
+        *below = t ;
+    }
+    update_size(board, t) ;
+}
+
+// puts node n into tree t, returns the new root
+static unsigned short insert(leaderboard_t *board, unsigned short t, unsigned short n) {
+    if (t == 0) return n ;
+    if (priority(board, n) > priority(board, t)) {
+        split(board, t, n, &NODE(n).left, &NODE(n).right) ;
+        update_size(board, n) ;
+        return n ;
+    }
+    if (ranks_above(board, n, t)) NODE(t).left = insert(board, NODE(t).left, n) ;
+    else NODE(t).right = insert(board, NODE(t).right, n) ;
+    update_size(board, t) ;
+    return t ;
+}
+
+// takes the lowest ranked node (*removed) out of tree t, returns the new root
+static unsigned short remove_last(leaderboard_t *board, unsigned short t, unsigned short *removed) {
+    if (NODE(t).right == 0) { *removed = t ; return NODE(t).left ; }
+    NODE(t).right = remove_last(board, NODE(t).right, removed) ;
+    NODE(t).size-- ;
+    return t ;
+}
+
+// rank of node n: 1 + the number of nodes above it
+static int node_rank(const leaderboard_t *board, unsigned short n) {
+    int above = 0 ;
+    for (unsigned short t = board->root; t != 0 && t != n; ) {
+        if (ranks_above(board, n, t)) { t = NODE(t).left ; }
+        else { above += SIZE(NODE(t).left) + 1 ; t = NODE(t).right ; }
+    }
+    return above + SIZE(NODE(n).left) + 1 ;
+}
+
+// the best[][] slot for record's initials, NULL if they aren't two letters A-Z
+static unsigned short *best_slot(leaderboard_t *board, const char *initials) {
+    if (initials[0] < 'A' || initials[0] > 'Z' || initials[1] < 'A' || initials[1] > 'Z') return NULL ;
+    return &board->best[initials[0] - 'A'][initials[1] - 'A'] ;
+}
+
+void leaderboard_init(leaderboard_t *board) {
+    board->root = 0 ;
+    board->count = 0 ;
+    board->order = 0 ;
+    memset(board->best, 0, sizeof(board->best)) ;
+}
+
+int leaderboard_add(leaderboard_t *board, const leaderboard_record_t *record) {
+    if (leaderboard_get_rank(board, record->score) > LEADERBOARD_MAX_ENTRIES) return 0 ;
+
+    unsigned short n ;
+    if (board->count < LEADERBOARD_MAX_ENTRIES) {
+        n = ++board->count ;
+    } else { // full: the lowest entry makes room
+        board->root = remove_last(board, board->root, &n) ;
+        unsigned short *best = best_slot(board, NODE(n).record.initials) ;
+        if (best != NULL && *best == n) *best = 0 ;
+    }
+    NODE(n).record = *record ;
+    NODE(n).order = board->order++ ;
+    NODE(n).left = NODE(n).right = 0 ;
+    NODE(n).size = 1 ;
+    board->root = insert(board, board->root, n) ;
+
+    unsigned short *best = best_slot(board, record->initials) ;
+    if (best != NULL && (*best == 0 || ranks_above(board, n, *best))) *best = n ;
+    return node_rank(board, n) ;
+}
+
+int leaderboard_get_rank(const leaderboard_t *board, unsigned int score) {
+    int above = 0 ; // (a new entry ranks above its ties: count the higher scores)
+    for (unsigned short t = board->root; t != 0; ) {
+        if (NODE(t).record.score > score) { above += SIZE(NODE(t).left) + 1 ; t = NODE(t).right ; }
+        else { t = NODE(t).left ; }
+    }
+    return above + 1 ;
+}
+
+// in-order walk of tree t that skips its first *skip entries (whole subtrees at a time)
+static void collect(const leaderboard_t *board, unsigned short t, int *skip, leaderboard_record_t *records, int *got, int n) {
+    if (t == 0 || *got == n) return ;
+    if (*skip >= SIZE(NODE(t).left)) *skip -= SIZE(NODE(t).left) ;
+    else collect(board, NODE(t).left, skip, records, got, n) ;
+    if (*got == n) return ;
+    if (*skip > 0) (*skip)-- ;
+    else records[(*got)++] = NODE(t).record ;
+    collect(board, NODE(t).right, skip, records, got, n) ;
+}
+
+int leaderboard_get_page(const leaderboard_t *board, int rank, leaderboard_record_t *records, int n) {
+    if (rank < 1 || n <= 0) return 0 ;
+    int skip = rank - 1 ; int got = 0 ;
+    collect(board, board->root, &skip, records, &got, n) ;
+    return got ;
+}
+
+bool leaderboard_get_best(const leaderboard_t *board, const char *initials, leaderboard_record_t *record, int *rank) {
+    unsigned short *best = best_slot((leaderboard_t *)board, initials) ;
+    if (best == NULL || *best == 0) return false ;
+    *record = NODE(*best).record ;
+    if (rank != NULL) *rank = node_rank(board, *best) ;
+    return true ;
+}
+
+int leaderboard_get_count(const leaderboard_t *board) {
+    return board->count ;
+}
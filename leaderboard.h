@@ -0,0 +1,71 @@
+/* leaderboard.h
+ * Module for the all-time leaderboard: every saved score in rank order, for thousands of players
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * The entries are kept in a tree sorted by rank (a treap: each node also has a pseudo-random priority
+ * that keeps it balanced) where every node knows how many entries are under it. So adding an entry,
+ * finding the rank a score gets ("you placed #312") and finding the entry at a rank all take O(log n)
+ * steps, and a page of the board is O(log n) plus one step per entry on it. A 26 x 26 table keeps each
+ * player's (initials') best entry. Higher scores rank higher, and the most recent of a tie ranks
+ * highest. All nodes are in a static pool (no malloc): once the board is full, an entry that ranks
+ * high enough pushes the lowest one off.
+ */
+
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <stdbool.h>
+#include "leaderboard_log.h" // leaderboard_record_t
+
+#define LEADERBOARD_MAX_ENTRIES 10240
+
+typedef struct {
+    leaderboard_record_t record ;
+    unsigned int order ;          // when it was added (later ties rank higher)
+    unsigned short left, right ;  // subtrees of higher / lower ranked entries (0 = none)
+    unsigned short size ;         // entries in this subtree
+} leaderboard_node_t ;
+
+typedef struct {
+    leaderboard_node_t nodes[LEADERBOARD_MAX_ENTRIES + 1] ; // nodes[0] is unused: 0 means none
+    unsigned short root ;
+    int count ;
+    unsigned int order ;          // of the next entry
+    unsigned short best[26][26] ; // node of the best entry for initials A-Z A-Z (0 = none)
+} leaderboard_t ;
+
+/* 'leaderboard_init'
+ * @functionality - empties the board
+ */
+void leaderboard_init(leaderboard_t *board) ;
+
+/* 'leaderboard_add'
+ * @param record - the entry (copied)
+ * @return - its rank (1 = top), or 0 if the board is full and it ranks below every entry
+ */
+int leaderboard_add(leaderboard_t *board, const leaderboard_record_t *record) ;
+
+/* 'leaderboard_get_rank'
+ * @return - the rank a new entry with score would get: above LEADERBOARD_MAX_ENTRIES if it wouldn't be kept
+ */
+int leaderboard_get_rank(const leaderboard_t *board, unsigned int score) ;
+
+/* 'leaderboard_get_page'
+ * @param rank - the first rank on the page (1 = top)
+ * @param records - filled in with the entries from rank on, at most n of them
+ * @return - the number of entries filled in (fewer than n at the bottom of the board)
+ */
+int leaderboard_get_page(const leaderboard_t *board, int rank, leaderboard_record_t *records, int n) ;
+
+/* 'leaderboard_get_best'
+ * @param initials - 2 letters A-Z
+ * @param record, rank - filled in with that player's best entry and its rank (rank may be NULL)
+ * @return - false if the player has no entry on the board
+ * (an entry pushed off a full board is the lowest there is, so the player's other entries, if any,
+ * are about to go too: it is forgotten as their best rather than replaced)
+ */
+bool leaderboard_get_best(const leaderboard_t *board, const char *initials, leaderboard_record_t *record, int *rank) ;
+
+int leaderboard_get_count(const leaderboard_t *board) ;
+
+#endif
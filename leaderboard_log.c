@@ -0,0 +1,165 @@
+/* leaderboard_log.c
+ * Module for keeping leaderboard scores on block storage as an append-only log (see leaderboard_log.h)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * a half of the storage:
+ *    block 0: header -- "TLOG", generation (4 bytes), checksum (2 bytes), zeros
+ *    block 1 on: records, 32 per block, in the order they were saved
+ * a record (16 bytes, multi-byte numbers little-endian):
+ *    magic (1) | initials (2) | generation tag (1) | score (4) | lines (2) | time (4) | checksum (2)
+ * the checksums are Fletcher-16 over the bytes before them
+ */
+
+#include "leaderboard_log.h"
+#include "strings.h"
+
+#define RECORD_SIZE 16
+#define RECORDS_PER_BLOCK (STORAGE_BLOCK_SIZE / RECORD_SIZE)
+#define RECORD_MAGIC 0xA5
+
+static const unsigned char header_magic[4] = { 'T', 'L', 'O', 'G' } ;
+
+// little-endian numbers in a byte buffer
+static void put16(unsigned char *p, unsigned int v) { p[0] = v & 0xFF ; p[1] = (v >> 8) & 0xFF ; }
+static void put32(unsigned char *p, unsigned int v) { put16(p, v & 0xFFFF) ; put16(p + 2, v >> 16) ; }
+static unsigned int get16(const unsigned char *p) { return p[0] | (p[1] << 8) ; }
+static unsigned int get32(const unsigned char *p) { return get16(p) | (get16(p + 2) << 16) ; }
+
+static unsigned int fletcher16(const unsigned char *p, int n) {
+    unsigned int a = 0 ; unsigned int b = 0 ;
+    for (int i = 0; i < n; i++) {
+        a = (a + p[i]) % 255 ;
+        b = (b + a) % 255 ;
+    }
+    return (b << 8) | a ;
+}
+
+static unsigned long capacity(const leaderboard_log_t *log) {
+    return (log->half_blocks - 1) * RECORDS_PER_BLOCK ;
+}
+
+// block number of record index in half
+static unsigned long record_block(const leaderboard_log_t *log, int half, unsigned long index) {
+    return half * log->half_blocks + 1 + index / RECORDS_PER_BLOCK ;
+}
+
+static void encode_record(unsigned char *p, const leaderboard_record_t *record, unsigned int generation) {
+    p[0] = RECORD_MAGIC ;
+    p[1] = record->initials[0] ;
+    p[2] = record->initials[1] ;
+    p[3] = generation & 0xFF ;
+    put32(p + 4, record->score) ;
+    put16(p + 8, record->lines) ;
+    put32(p + 10, record->time) ;
+    put16(p + 14, fletcher16(p, 14)) ;
+}
+
+// false if p isn't a record of this generation
+static bool decode_record(const unsigned char *p, leaderboard_record_t *record, unsigned int generation) {
+    if (p[0] != RECORD_MAGIC || p[3] != (generation & 0xFF) || get16(p + 14) != fletcher16(p, 14)) return false ;
+    record->initials[0] = p[1] ;
+    record->initials[1] = p[2] ;
+    record->score = get32(p + 4) ;
+    record->lines = get16(p + 8) ;
+    record->time = get32(p + 10) ;
+    return true ;
+}
+
+static bool write_header(const leaderboard_log_t *log, int half, unsigned int generation) {
+    unsigned char block[STORAGE_BLOCK_SIZE] ;
+    memset(block, 0, sizeof(block)) ;
+    memcpy(block, header_magic, sizeof(header_magic)) ;
+    put32(block + 4, generation) ;
+    put16(block + 8, fletcher16(block, 8)) ;
+    return storage_write(half * log->half_blocks, block) ;
+}
+
+// generation of half's header, 0 if it has none
+static unsigned int read_header(const leaderboard_log_t *log, int half) {
+    unsigned char block[STORAGE_BLOCK_SIZE] ;
+    if (!storage_read(half * log->half_blocks, block)) return 0 ;
+    for (int i = 0; i < (int)sizeof(header_magic); i++) {
+        if (block[i] != header_magic[i]) return 0 ;
+    }
+    if (get16(block + 8) != fletcher16(block, 8)) return 0 ;
+    return get32(block + 4) ;
+}
+
+bool leaderboard_log_open(leaderboard_log_t *log, void (*load)(const leaderboard_record_t *record, void *arg), void *arg) {
+    memset(log, 0, sizeof(*log)) ;
+    if (!storage_init() || storage_get_nblocks() < 4) return false ;
+    log->half_blocks = storage_get_nblocks() / 2 ;
+
+    // the log is the half with the newest header
+    unsigned int generations[2] = { read_header(log, 0), read_header(log, 1) } ;
+    log->half = (generations[1] > generations[0]) ? 1 : 0 ;
+    log->generation = generations[log->half] ;
+    if (log->generation == 0) { // blank storage: start an empty log
+        log->generation = 1 ;
+        if (!write_header(log, 0, log->generation)) { log->half_blocks = 0 ; return false ; }
+        return true ; // (log->block is all zeros, like the blank first record block)
+    }
+
+    // scan the records up to the first one that isn't part of the log
+    leaderboard_record_t record ;
+    while (log->count < capacity(log)) {
+        int slot = log->count % RECORDS_PER_BLOCK ;
+        if (slot == 0 && !storage_read(record_block(log, log->half, log->count), log->block)) break ;
+        if (!decode_record(log->block + slot * RECORD_SIZE, &record, log->generation)) break ;
+        if (load != NULL) load(&record, arg) ;
+        log->count++ ;
+    }
+    // keep the block the next record goes in as stored, minus anything after the end of the log
+    if (log->count % RECORDS_PER_BLOCK == 0) {
+        memset(log->block, 0, sizeof(log->block)) ;
+    } else {
+        int end = (log->count % RECORDS_PER_BLOCK) * RECORD_SIZE ;
+        memset(log->block + end, 0, sizeof(log->block) - end) ;
+    }
+    return true ;
+}
+
+bool leaderboard_log_append(leaderboard_log_t *log, const leaderboard_record_t *record) {
+    if (log->half_blocks == 0 || log->count >= capacity(log)) return false ;
+    int slot = log->count % RECORDS_PER_BLOCK ;
+    encode_record(log->block + slot * RECORD_SIZE, record, log->generation) ;
+    if (!storage_write(record_block(log, log->half, log->count), log->block)) {
+        memset(log->block + slot * RECORD_SIZE, 0, RECORD_SIZE) ;
+        return false ;
+    }
+    log->count++ ;
+    if (log->count % RECORDS_PER_BLOCK == 0) memset(log->block, 0, sizeof(log->block)) ; // on to a fresh block
+    return true ;
+}
+
+bool leaderboard_log_compact(leaderboard_log_t *log, const leaderboard_record_t *records, int n) {
+    if (log->half_blocks == 0 || n < 0 || (unsigned long)n > capacity(log)) return false ;
+    int half = 1 - log->half ;
+    unsigned int generation = log->generation + 1 ;
+
+    // records first (whole blocks, the last one padded with zeros), the header that makes them the log last
+    unsigned char block[STORAGE_BLOCK_SIZE] ;
+    for (int i = 0; i < n || (i == 0 && n == 0); i += RECORDS_PER_BLOCK) {
+        memset(block, 0, sizeof(block)) ;
+        for (int j = 0; j < RECORDS_PER_BLOCK && i + j < n; j++) {
+            encode_record(block + j * RECORD_SIZE, &records[i + j], generation) ;
+        }
+        if (!storage_write(record_block(log, half, i), block)) return false ;
+    }
+    if (!write_header(log, half, generation)) return false ;
+
+    log->half = half ;
+    log->generation = generation ;
+    log->count = n ;
+    if (n % RECORDS_PER_BLOCK == 0) memset(block, 0, sizeof(block)) ;
+    memcpy(log->block, block, sizeof(block)) ;
+    return true ;
+}
+
+unsigned long leaderboard_log_get_count(const leaderboard_log_t *log) {
+    return log->count ;
+}
+
+unsigned long leaderboard_log_get_free(const leaderboard_log_t *log) {
+    return (log->half_blocks == 0) ? 0 : capacity(log) - log->count ;
+}
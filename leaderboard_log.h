@@ -0,0 +1,62 @@
+/* leaderboard_log.h
+ * Module for keeping leaderboard scores on block storage (storage.h) as an append-only log
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * Every score saved is one 16-byte record (initials, score, lines, time, checksum) added after the
+ * last one, so saving writes a single block. Opening the log scans the records in order and hands
+ * each one to a callback (the interlude keeps its top scores). When the log fills up, compaction
+ * rewrites just the records worth keeping into the other half of the storage and switches to it --
+ * the old half stays valid until the new one is complete, so a reset in the middle loses nothing.
+ *
+ * Storage layout: two halves, each a header block (magic, generation, checksum) followed by record
+ * blocks of 32 records. The half with the newest valid header is the log. A record belongs to it only
+ * if its magic, generation tag and checksum all match, so the scan stops at the first one that doesn't
+ * (blank storage, a half-written block, records left over from an older generation).
+ */
+
+#ifndef LEADERBOARD_LOG_H
+#define LEADERBOARD_LOG_H
+
+#include <stdbool.h>
+#include "storage.h"
+
+typedef struct {
+    char initials[2] ;
+    unsigned int score ;
+    unsigned short lines ;
+    unsigned int time ; // seconds since boot when it was saved (the Mango Pi has no clock)
+} leaderboard_record_t ;
+
+typedef struct {
+    unsigned long half_blocks ; // blocks per half (header included)
+    int half ;                  // the half in use (0 or 1)
+    unsigned int generation ;   // of the half in use: one more at every compaction
+    unsigned long count ;       // records in the log (the next one goes at index count)
+    unsigned char block[STORAGE_BLOCK_SIZE] ; // the block record count goes in, as stored
+} leaderboard_log_t ;
+
+/* 'leaderboard_log_open'
+ * @param load - called with every record in the log, oldest first (may be NULL)
+ * @return - false if the storage can't be used (the log then stays empty and appends fail)
+ * @functionality - finds the log on storage (setting up an empty one the first time) and reads it
+ */
+bool leaderboard_log_open(leaderboard_log_t *log, void (*load)(const leaderboard_record_t *record, void *arg), void *arg) ;
+
+/* 'leaderboard_log_append'
+ * @return - false if the log is full (compact it first) or the write failed
+ * @functionality - adds record at the end of the log: one block write
+ */
+bool leaderboard_log_append(leaderboard_log_t *log, const leaderboard_record_t *record) ;
+
+/* 'leaderboard_log_compact'
+ * @param records - the n records to keep (everything else in the log is dropped)
+ * @return - false if they don't fit or a write failed (the log is then as it was)
+ * @functionality - writes the records into the other half, then makes that half the log
+ */
+bool leaderboard_log_compact(leaderboard_log_t *log, const leaderboard_record_t *records, int n) ;
+
+// number of records in the log / how many more fit before it has to be compacted
+unsigned long leaderboard_log_get_count(const leaderboard_log_t *log) ;
+unsigned long leaderboard_log_get_free(const leaderboard_log_t *log) ;
+
+#endif
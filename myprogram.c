@@ -1,7 +1,10 @@
 #include "uart.h"
 #include "testing.h"
+#include "pixel_kernels.h"
 
 void main(void) {
+    pixel_kernels_init(); // (the vector unit, in a vector build)
+
     // INITIAL TEST CYCLES
     // uart_init();
     // say_hello("CS107e"); 
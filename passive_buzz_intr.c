@@ -9,9 +9,11 @@
 #include "interrupts.h"
 #include "hstimer.h"
 #include "music.h"
+#include "song.h"
+#include "song_assets.h"
+#include "isr_stats.h"
 #include <stddef.h>
 
-#define uSEC_IN_SEC 1000000
 #define TEMPO_CONSTANT 54000000 // tuned, and it works :)
 
 // class info
@@ -20,66 +22,150 @@ static int tempo ; // converted from beats per minute to a frequency (Hz)
 static bool is_playing ;
 
 // song info
-const int song_length =93 ;
-const int tetris_song[93][2] = // note freq followed by duration. each 2 lines are a measure. each 8 lines is a grouped musical phrase
-                    {   
-                        // // theme
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_B_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_E, NOTE_IPT_QUARTER},
-                        {NOTE_FREQ_C, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, 
-                        {NOTE_FREQ_A_3, NOTE_IPT_HALF}, 
-
-                        {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_F, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_A, NOTE_IPT_QUARTER}, {NOTE_FREQ_G, NOTE_IPT_EIGHTH}, {NOTE_FREQ_F, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER+NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_B_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_E, NOTE_IPT_QUARTER},
-                        {NOTE_FREQ_C, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, 
-                        {NOTE_FREQ_A_3, NOTE_IPT_HALF}, 
-                        
-                        // theme again
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_B_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_E, NOTE_IPT_QUARTER},
-                        {NOTE_FREQ_C, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, 
-                        {NOTE_FREQ_A_3, NOTE_IPT_HALF}, 
-
-                        {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_F, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_A, NOTE_IPT_QUARTER}, {NOTE_FREQ_G, NOTE_IPT_EIGHTH}, {NOTE_FREQ_F, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER+NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_D, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH},
-                        {NOTE_FREQ_B_3, NOTE_IPT_QUARTER}, {NOTE_FREQ_B_3, NOTE_IPT_EIGHTH}, {NOTE_FREQ_C, NOTE_IPT_EIGHTH}, 
-                        {NOTE_FREQ_D, NOTE_IPT_QUARTER}, {NOTE_FREQ_E, NOTE_IPT_QUARTER},
-                        {NOTE_FREQ_C, NOTE_IPT_QUARTER}, {NOTE_FREQ_A_3, NOTE_IPT_QUARTER}, 
-                        {NOTE_FREQ_A_3, NOTE_IPT_HALF}, 
-                       
-                        // // slow falling part (each line is a full measure)
-                        {NOTE_FREQ_E, NOTE_IPT_HALF}, {NOTE_FREQ_C, NOTE_IPT_HALF}, 
-                        {NOTE_FREQ_D, NOTE_IPT_HALF}, {NOTE_FREQ_B_3, NOTE_IPT_HALF},
-                        {NOTE_FREQ_C, NOTE_IPT_HALF}, {NOTE_FREQ_A_3, NOTE_IPT_HALF},
-                        {NOTE_FREQ_G_SHARP_3, NOTE_IPT_WHOLE},
-
-                        {NOTE_FREQ_E, NOTE_IPT_HALF}, {NOTE_FREQ_C, NOTE_IPT_HALF}, 
-                        {NOTE_FREQ_D, NOTE_IPT_HALF}, {NOTE_FREQ_B_3, NOTE_IPT_HALF},
-                        {NOTE_FREQ_C, NOTE_IPT_QUARTER}, {NOTE_FREQ_E, NOTE_IPT_QUARTER}, {NOTE_FREQ_A, NOTE_IPT_HALF},
-                        {NOTE_FREQ_G_SHARP, NOTE_IPT_WHOLE}
-                    } ;
+// notes are decoded from the packed song into a small double-buffered window: the note-change
+// interrupt plays from the front half while decoding one note per interrupt into the back half,
+// so the cost per interrupt stays constant no matter how long the song is
+#define SONG_WINDOW 8
+
+static song_t tetris ; // built-in song played by buzzer_intr_init
+
+static struct {
+    const song_t *song ;                          // song currently playing
+    const song_t * volatile pending ;             // song to switch to on the next note change
+    song_event_t window[2][SONG_WINDOW] ;
+    int count[2] ;                                // number of decoded notes in each half
+    int front ;                                   // half currently being played
+    int pos ;                                     // next note to play in the front half
+    int next_index ;                              // next song event to decode (-1 once the song is over)
+    song_event_t note ;                           // note currently playing
+    bool finished ;                               // true once a non-looping song played its last note
+} player ;
+
+// `decode_next`
+// decodes the next song event into the end of half `half` of the window
+static void decode_next(int half) {
+    if (player.next_index < 0) return ;
+    song_decode(player.song, player.next_index, &player.window[half][player.count[half]++]) ;
+    player.next_index = song_next_index(player.song, player.next_index) ;
+}
 
-static int song_index ;
+// `player_load`
+// starts song from its first note: the front half of the window is decoded right away
+static void player_load(const song_t *song) {
+    player.song = song ;
+    player.next_index = (song->nevents > 0) ? 0 : -1 ;
+    player.front = 0 ;
+    player.pos = 0 ;
+    player.count[0] = player.count[1] = 0 ;
+    while (player.count[0] < SONG_WINDOW && player.next_index >= 0) decode_next(0) ;
+    player.finished = false ;
+}
+
+// `player_next_note`
+// @returns false if the song is over
+// takes the next note from the window, and refills the back half by one note
+static bool player_next_note(song_event_t *note) {
+    if (player.pos == player.count[player.front]) {
+        int back = !player.front ;
+        if (player.count[back] == 0) return false ; // nothing left to play
+        player.count[player.front] = 0 ;
+        player.front = back ;
+        player.pos = 0 ;
+    }
+    *note = player.window[player.front][player.pos++] ;
+    int back = !player.front ;
+    if (player.count[back] < SONG_WINDOW) decode_next(back) ;
+    return true ;
+}
+
+// sound effect info
+// effects time-multiplex with the song: an effect takes over the pitch timer (HSTIMER0) and counts
+// its own note lengths in buzzer toggles, while HSTIMER1 keeps stepping through the song silently.
+// when the effect ends, the song comes back on whichever note it has reached by then
+#define SFX_MAX_NOTES 6
+#define SFX_REST_HALF_PERIOD_US 500 // pitch timer rate while an effect is resting (buzzer stays low)
+
+typedef struct {
+    int freq ; // in Hz, 0 for a rest
+    int msec ;
+} sfx_note_t ;
+
+// effects are listed by priority: an effect only cuts off an effect of the same or lower priority
+static const sfx_note_t sfx_notes[SFX_COUNT][SFX_MAX_NOTES] = {
+    [SFX_ROTATE] =     { {1319, 25} },                                                  // click (E6)
+    [SFX_LINE_CLEAR] = { {523, 45}, {659, 45}, {784, 45}, {1047, 90} },                 // C5 E5 G5 C6 arpeggio
+    [SFX_GAME_OVER] =  { {494, 180}, {0, 40}, {440, 180}, {0, 40}, {392, 180}, {330, 500} }, // B4 A4 G4 E4
+} ;
+
+static struct {
+    volatile int pending ;      // effect to start on the next pitch interrupt (SFX_NONE if none)
+    int effect ;                // effect playing (SFX_NONE if the song has the buzzer)
+    int note ;                  // index into sfx_notes[effect]
+    int toggles_left ;          // pitch interrupts left in the current effect note
+    bool silent ;               // current effect note is a rest
+} sfx = { .pending = SFX_NONE, .effect = SFX_NONE } ;
+
+static bool buzz_on ; // whether HSTIMER0 should keep toggling the buzzer
+
+static long timer_interval_us[2] ; // interval each hstimer was last set to
+
+// `set_timer`
+// hstimer_init that remembers the interval
+static void set_timer(hstimer_id_t timer, long usecs) {
+    timer_interval_us[timer] = usecs ;
+    hstimer_init(timer, usecs) ;
+}
 
-// `freq_to_period_us`
-// @param frequency in Hertz (1/s)
-// @returns period in useconds
-static int freq_to_period_us(int frequency) {
-    return (uSEC_IN_SEC / frequency) ;
+// `start_timer`
+// hstimer_enable that also tells isr_stats when the interrupt is due (to measure how late it runs)
+static void start_timer(hstimer_id_t timer) {
+    hstimer_enable(timer) ;
+    isr_stats_arm(timer == HSTIMER0 ? INTERRUPT_SOURCE_HSTIMER0 : INTERRUPT_SOURCE_HSTIMER1, timer_interval_us[timer]) ;
+}
+
+// `song_pitch`
+// hands the pitch timer back to the song's current note (or silence for a rest / paused music)
+static void song_pitch(void) {
+    buzz_on = is_playing && !player.finished && player.note.half_period_us != 0 ;
+    if (buzz_on) set_timer(HSTIMER0, player.note.half_period_us) ;
+}
+
+// `sfx_start_note`
+// @returns false once the effect has no notes left
+// sets the pitch timer to the effect's current note, and works out how many toggles it lasts
+static bool sfx_start_note(void) {
+    if (sfx.note >= SFX_MAX_NOTES) return false ;
+    const sfx_note_t *note = &sfx_notes[sfx.effect][sfx.note] ;
+    if (note->msec == 0) return false ; // unused slots are zeroed
+
+    sfx.silent = (note->freq == 0) ;
+    int half_period_us = sfx.silent ? SFX_REST_HALF_PERIOD_US : (1000000 / note->freq) / 2 ;
+    sfx.toggles_left = (note->msec * 1000) / half_period_us ;
+    if (sfx.toggles_left == 0) sfx.toggles_left = 1 ;
+    set_timer(HSTIMER0, half_period_us) ;
+    buzz_on = true ;
+    return true ;
+}
+
+// `sfx_step`
+// called on every pitch interrupt: starts a pending effect, or moves on to the effect's next note
+static void sfx_step(void) {
+    int pending = sfx.pending ;
+    if (pending != SFX_NONE) {
+        sfx.pending = SFX_NONE ;
+        sfx.effect = pending ;
+        sfx.note = 0 ;
+    } else if (sfx.effect == SFX_NONE || --sfx.toggles_left > 0) {
+        return ;
+    } else {
+        sfx.note++ ;
+    }
+
+    if (!sfx_start_note()) { // effect is over: the song takes the buzzer back
+        sfx.effect = SFX_NONE ;
+        sfx.silent = false ;
+        song_pitch() ;
+    }
 }
 
 // `handle_note_buzz`
@@ -88,11 +174,36 @@ static int freq_to_period_us(int frequency) {
 static void handle_note_buzz(uintptr_t pc, void *aux_data) {
     hstimer_interrupt_clear(HSTIMER0);
 
-    // toggle buzzer
-    if (gpio_read(buzzer_id) == 1) gpio_write(buzzer_id, 0);
-    else gpio_write(buzzer_id, 1);
+    sfx_step() ;
+
+    if (!buzz_on) { // song is resting/paused and no effect is playing
+        gpio_write(buzzer_id, 0) ;
+        hstimer_disable(HSTIMER0) ;
+    } else {
+        // toggle buzzer
+        if (sfx.silent || gpio_read(buzzer_id) == 1) gpio_write(buzzer_id, 0);
+        else gpio_write(buzzer_id, 1);
+
+        start_timer(HSTIMER0);
+    }
+}
 
-    hstimer_enable(HSTIMER0);
+// `start_note`
+// points HSTIMER0 at the note's pitch (or silences it for a rest) and HSTIMER1 at its length
+// while a sound effect is playing, only the song's place is updated
+static void start_note(const song_event_t *note) {
+    player.note = *note ;
+    if (sfx.effect == SFX_NONE && sfx.pending == SFX_NONE) {
+        song_pitch() ;
+        if (buzz_on) start_timer(HSTIMER0) ;
+        else { // rest
+            hstimer_disable(HSTIMER0) ;
+            gpio_write(buzzer_id, 0) ;
+        }
+    }
+
+    set_timer(HSTIMER1, tempo * note->eighths) ; // for the proper note length
+    start_timer(HSTIMER1) ;
 }
 
 // `handle_note_change`
@@ -102,17 +213,26 @@ static void handle_note_buzz(uintptr_t pc, void *aux_data) {
 static void handle_note_change(uintptr_t pc, void *aux_data) {
     hstimer_interrupt_clear(HSTIMER1);
 
-    // iterates to next note in the song 
-    song_index = (song_index+1) % song_length; // 8*4*6 is the number of notes in the tetris song
-
-    // changes the frequency that the buzzer will buzz at
-    // remember: we need to use note freq / 2 for the toggle in handle_note_buzz to work
-    // hstimer_init(HSTIMER0, (freq_to_period_us(SONG[song_index][0]) / 2)); 
-    hstimer_init(HSTIMER0, (freq_to_period_us(tetris_song[song_index][0]) / 2)) ; 
-    hstimer_enable(HSTIMER0) ;
+    // switching songs only touches the window, so the interrupts keep running
+    const song_t *pending = player.pending ;
+    if (pending != NULL) {
+        player.pending = NULL ;
+        player_load(pending) ;
+    }
 
-    hstimer_init(HSTIMER1, tempo * tetris_song[song_index][1]) ; // for the proper note length
-    hstimer_enable(HSTIMER1) ;
+    // iterates to next note in the song 
+    song_event_t note ;
+    if (player_next_note(&note)) {
+        start_note(&note) ;
+    } else { // song is over: go quiet until a new song is played
+        player.finished = true ;
+        player.note.half_period_us = 0 ;
+        if (sfx.effect == SFX_NONE) {
+            buzz_on = false ;
+            hstimer_disable(HSTIMER0) ;
+            gpio_write(buzzer_id, 0) ;
+        }
+    }
 }
 
 // `buzzer_intr_init`
@@ -121,28 +241,54 @@ void buzzer_intr_init(gpio_id_t id, int tempo_) {
     gpio_set_output(id) ;
     buzzer_id = id ;
     
-    if (tempo_ < TEMPO_MIN) tempo_ = TEMPO_MIN ;
-    if (tempo_ > TEMPO_MAX) tempo_ = TEMPO_MAX ;
-    tempo = TEMPO_CONSTANT / (tempo_ * 2); // multiply by 2 because song's smallest note is in 8th notes, not quarter
-
-    song_index = 0 ;
+    song_parse(&tetris, song_tetris, song_tetris_size) ;
+    player.pending = NULL ;
+    player_load(&tetris) ;
+    buzzer_intr_set_tempo(tempo_) ;
 
     // initializing interrupt system to listen for timer
 
     // INTERRUPT_SOURCE_HSTIMER0 to pwm the note
     interrupts_enable_source(INTERRUPT_SOURCE_HSTIMER0); //= 71, # INTERRUPT_SOURCE_HSTIMER1 = 72,
-    interrupts_register_handler(INTERRUPT_SOURCE_HSTIMER0, handle_note_buzz, NULL) ;
-    hstimer_init(HSTIMER0, freq_to_period_us(tetris_song[song_index][0]) / 2) ; 
-    hstimer_enable(HSTIMER0) ;
+    isr_stats_register_handler(INTERRUPT_SOURCE_HSTIMER0, handle_note_buzz, NULL, "note_buzz") ;
 
     // INTERRUPT_SOURCE_HSTIMER1 to change which note is playing
     interrupts_enable_source(INTERRUPT_SOURCE_HSTIMER1); 
-    interrupts_register_handler(INTERRUPT_SOURCE_HSTIMER1, handle_note_change, NULL) ;
-    // hstimer_init(HSTIMER1, 300000) ; 
-    hstimer_init(HSTIMER1, tetris_song[song_index][1]) ; 
-    hstimer_enable(HSTIMER1) ;
+    isr_stats_register_handler(INTERRUPT_SOURCE_HSTIMER1, handle_note_change, NULL, "note_change") ;
 
     is_playing = true ;
+    song_event_t note ;
+    player_next_note(&note) ;
+    start_note(&note) ;
+}
+
+// `queue_song`
+// the switch happens in the note-change interrupt, so the current note finishes first
+static void queue_song(const song_t *song) {
+    player.pending = song ;
+    if (player.finished && is_playing) { // timers went quiet at the end of the last song; kick them
+        set_timer(HSTIMER1, 1) ;
+        start_timer(HSTIMER1) ;
+    }
+}
+
+// `buzzer_intr_play_song`
+// switches to song (at its own tempo) without touching the interrupt setup
+void buzzer_intr_play_song(const song_t *song) {
+    buzzer_intr_set_tempo(song->tempo) ;
+    queue_song(song) ;
+}
+
+// `buzzer_intr_get_song`
+// returns the song that is currently playing
+const song_t *buzzer_intr_get_song(void) {
+    return player.pending != NULL ? player.pending : player.song ;
+}
+
+// `buzzer_intr_get_default_song`
+// returns the built-in tetris theme
+const song_t *buzzer_intr_get_default_song(void) {
+    return &tetris ;
 }
 
 // `buzzer_intr_set_tempo`
@@ -150,7 +296,7 @@ void buzzer_intr_init(gpio_id_t id, int tempo_) {
 void buzzer_intr_set_tempo(int tempo_) {
     if (tempo_ < TEMPO_MIN) tempo_ = TEMPO_MIN ;
     if (tempo_ > TEMPO_MAX) tempo_ = TEMPO_MAX ;
-    tempo = TEMPO_CONSTANT / (tempo_ * 2) ; 
+    tempo = TEMPO_CONSTANT / (tempo_ * 2) ; // multiply by 2 because song's smallest note is in 8th notes, not quarter
 }
 
 // `buzzer_intr_get_tempo`
@@ -162,23 +308,40 @@ int buzzer_intr_get_tempo(void) {
 // `buzzer_intr_restart_song`
 // restarts the song on the next note-loop
 void buzzer_intr_restart_song(void) {
-    song_index = 0 ;
+    queue_song(buzzer_intr_get_song()) ;
 }
 
 // 'buzzer_intr_pause'
 // pause music
 void buzzer_intr_pause(void) {
     hstimer_disable(HSTIMER1) ;
-    hstimer_disable(HSTIMER0) ;
     is_playing = false ;
+    if (sfx.effect == SFX_NONE) { // a playing effect finishes on its own, then goes quiet
+        buzz_on = false ;
+        hstimer_disable(HSTIMER0) ;
+    }
 }
 
 // 'buzzer_intr_play'
 // resume music
 void buzzer_intr_play(void) {
-    hstimer_enable(HSTIMER0) ;
-    hstimer_enable(HSTIMER1) ;
     is_playing = true ;
+    if (sfx.effect == SFX_NONE) {
+        song_pitch() ;
+        if (buzz_on) start_timer(HSTIMER0) ; // rests stay quiet
+    }
+    start_timer(HSTIMER1) ;
+}
+
+// 'buzzer_intr_play_effect'
+// the effect starts on the next pitch interrupt; HSTIMER0 is kicked in case it is idle (rest/paused)
+void buzzer_intr_play_effect(int effect) {
+    if (effect < 0 || effect >= SFX_COUNT) return ;
+    int current = sfx.pending != SFX_NONE ? sfx.pending : sfx.effect ;
+    if (current != SFX_NONE && effect < current) return ; // lower priority than what's playing
+    sfx.pending = effect ;
+    set_timer(HSTIMER0, 1) ;
+    start_timer(HSTIMER0) ;
 }
 
 // 'buzzer_intr_is_playing'
@@ -9,11 +9,15 @@
 #include "gpio.h"
 #include <stdbool.h>
 #include "music.h"
+#include "song.h"
+
+// SOUND EFFECTS, in order of priority (a higher effect cuts off a lower one, never the other way)
+enum { SFX_NONE = -1, SFX_ROTATE = 0, SFX_LINE_CLEAR, SFX_GAME_OVER, SFX_COUNT } ;
 
 /* 'buzzer_intr_init'
  * @param gpio_id_t id - buzzer GPIO id
  * @param int tempo_ - music tempo. use a reasonable tempo (choose from music.h's tempo enum options)
- * @functionality - init the interrupt system for the buzzer and start playing tetris song!
+ * @functionality - init the interrupt system for the buzzer and start playing tetris song (songs/tetris.txt)!
  * ask yourself: Do I want to multitask and play a song continuously in the background? 
  *      Yes: You are in the right place. 
  *      No: Want to play a single note and *not* multitask? See passive_buzz.c
@@ -31,6 +35,24 @@ void buzzer_intr_set_tempo(int tempo_) ;
 */
 int buzzer_intr_get_tempo(void) ;
 
+/* 'buzzer_intr_play_song'
+ * @param const song_t *song - song to play (see song.h). must stay around while it plays
+ * @functionality - switches to song on the next note, at the song's own tempo. interrupts are not
+ *                  re-initialized, so this is cheap enough to call between screens. looped songs play
+ *                  forever; other songs go quiet after their last note
+*/
+void buzzer_intr_play_song(const song_t *song) ;
+
+/* 'buzzer_intr_get_song'
+ * @return - the song currently playing (or about to play, if a switch is pending)
+*/
+const song_t *buzzer_intr_get_song(void) ;
+
+/* 'buzzer_intr_get_default_song'
+ * @return - the built-in tetris theme that buzzer_intr_init starts with
+*/
+const song_t *buzzer_intr_get_default_song(void) ;
+
 /* 'buzzer_intr_restart_song'
  * @functionality - restarts the song on the next note
 */
@@ -52,4 +74,12 @@ void buzzer_intr_play(void) ;
 */
 bool buzzer_intr_is_playing(void) ;
 
+/* 'buzzer_intr_play_effect'
+ * @param int effect - one of the SFX_ enum options above
+ * @functionality - plays a short sound effect over the music without blocking. the song is muted while the
+ *                  effect plays but keeps time, so it comes back in on the right note. an effect that is
+ *                  lower priority than the one already playing is dropped. effects play even if the music is paused
+*/
+void buzzer_intr_play_effect(int effect) ;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,385 @@
+/* pixel_kernels.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The pixel_kernels.c module has the loops that write pixels for render.c and game_update.c, in two
+* versions: RISC-V vector (RVV intrinsics, when the compiler targets the vector extension) and scalar
+* C. The scalar ones are always built too, so the two can be checked against each other and timed.
+*/
+
+#include "pixel_kernels.h"
+#include <stdint.h>
+#include "printf.h"
+#include "cycle_count.h"
+#if PIXEL_KERNELS_RVV
+#include <riscv_vector.h>
+#endif
+
+// Scalar kernels
+
+// One store lines dst up on 8 bytes, then two pixels per store
+void pixel_scalar_fill(color_t* dst, size_t n, color_t color) {
+    if (n > 0 && ((uintptr_t)dst & 4) != 0) {
+        *dst++ = color;
+        n--;
+    }
+    pixel_pair_t pair = pixel_pair(color, color);
+    pixel_pair_t* pairs = (pixel_pair_t*)dst;
+    for (; n >= 2; n -= 2) *pairs++ = pair;
+    if (n > 0) *(color_t*)pairs = color;
+}
+
+void pixel_scalar_fill_rect(color_t* dst, int stride, int w, int h, color_t color) {
+    if (w <= 0) return;
+    for (int row = 0; row < h; row++) pixel_scalar_fill(dst + row * stride, w, color);
+}
+
+// Helper to copy n pixels: two at a time when dst and src line up the same way on 8 bytes
+static void scalarCopy(color_t* dst, const color_t* src, int n) {
+    if (n > 0 && ((uintptr_t)dst & 4) != 0) {
+        *dst++ = *src++;
+        n--;
+    }
+    if (((uintptr_t)src & 4) == 0) {
+        pixel_pair_t* d = (pixel_pair_t*)dst;
+        const pixel_pair_t* s = (const pixel_pair_t*)src;
+        for (; n >= 2; n -= 2) *d++ = *s++;
+        dst = (color_t*)d;
+        src = (const color_t*)s;
+    }
+    for (; n > 0; n--) *dst++ = *src++;
+}
+
+void pixel_scalar_copy_rect(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h) {
+    for (int row = 0; row < h; row++) scalarCopy(dst + row * dst_stride, src + row * src_stride, w);
+}
+
+void pixel_scalar_blit_keyed(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h, color_t key) {
+    for (int row = 0; row < h; row++) {
+        color_t* d = dst + row * dst_stride;
+        const color_t* s = src + row * src_stride;
+        for (int col = 0; col < w; col++) {
+            if (s[col] != key) d[col] = s[col];
+        }
+    }
+}
+
+// 16-bit pixels go four to a 64-bit store, once dst is lined up on 8 bytes
+void pixel_scalar_fill16(pixel16_t* dst, size_t n, pixel16_t color) {
+    for (; n > 0 && ((uintptr_t)dst & 6) != 0; n--) *dst++ = color;
+    pixel_pair_t quad = pixel_quad16(color, color, color, color);
+    pixel_pair_t* quads = (pixel_pair_t*)dst;
+    for (; n >= 4; n -= 4) *quads++ = quad;
+    for (dst = (pixel16_t*)quads; n > 0; n--) *dst++ = color;
+}
+
+void pixel_scalar_fill_rect16(pixel16_t* dst, int stride, int w, int h, pixel16_t color) {
+    if (w <= 0) return;
+    for (int row = 0; row < h; row++) pixel_scalar_fill16(dst + row * stride, w, color);
+}
+
+void pixel_scalar_copy_rect16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h) {
+    for (int row = 0; row < h; row++) {
+        pixel16_t* d = dst + row * dst_stride;
+        const pixel16_t* s = src + row * src_stride;
+        int n = w;
+        for (; n > 0 && ((uintptr_t)d & 6) != 0; n--) *d++ = *s++;
+        if (((uintptr_t)s & 6) == 0) {
+            for (; n >= 4; n -= 4, d += 4, s += 4) *(pixel_pair_t*)d = *(const pixel_pair_t*)s;
+        }
+        for (; n > 0; n--) *d++ = *s++;
+    }
+}
+
+void pixel_scalar_blit_keyed16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h, pixel16_t key) {
+    for (int row = 0; row < h; row++) {
+        pixel16_t* d = dst + row * dst_stride;
+        const pixel16_t* s = src + row * src_stride;
+        for (int col = 0; col < w; col++) {
+            if (s[col] != key) d[col] = s[col];
+        }
+    }
+}
+
+void pixel_scalar_expand565(color_t* dst, const pixel16_t* src, size_t n) {
+    for (; n > 0; n--) *dst++ = pixel_from_565(*src++);
+}
+
+// mstatus.VS, the vector unit's state: bits 23-24 on the C906 (RVV 0.7.1), 9-10 in RVV 1.0. Setting
+// both bits (dirty) turns the unit on. On Linux (kernels-qemu) the kernel has already done it, and
+// mstatus can't be reached from user mode anyway
+void pixel_kernels_init(void) {
+#if PIXEL_KERNELS_RVV && !defined(__linux__)
+#if defined(__riscv_xtheadvector)
+    unsigned long vs = 3UL << 23;
+#else
+    unsigned long vs = 3UL << 9;
+#endif
+    __asm__ volatile("csrs mstatus, %0" : : "r"(vs));
+#endif
+}
+
+// Vector kernels (LMUL 8: each instruction works on as many pixels as 8 vector registers hold)
+#if PIXEL_KERNELS_RVV
+
+void pixel_fill(color_t* dst, size_t n, color_t color) {
+    vuint32m8_t v = __riscv_vmv_v_x_u32m8(color, __riscv_vsetvlmax_e32m8());
+    while (n > 0) {
+        size_t vl = __riscv_vsetvl_e32m8(n);
+        __riscv_vse32_v_u32m8(dst, v, vl);
+        dst += vl;
+        n -= vl;
+    }
+}
+
+void pixel_fill_rect(color_t* dst, int stride, int w, int h, color_t color) {
+    if (w <= 0) return;
+    for (int row = 0; row < h; row++) pixel_fill(dst + row * stride, w, color);
+}
+
+void pixel_copy_rect(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h) {
+    for (int row = 0; row < h; row++) {
+        color_t* d = dst + row * dst_stride;
+        const color_t* s = src + row * src_stride;
+        for (size_t n = (w > 0) ? w : 0; n > 0; ) {
+            size_t vl = __riscv_vsetvl_e32m8(n);
+            __riscv_vse32_v_u32m8(d, __riscv_vle32_v_u32m8(s, vl), vl);
+            d += vl;
+            s += vl;
+            n -= vl;
+        }
+    }
+}
+
+// The key test makes a mask, and the store only writes the pixels the mask keeps
+void pixel_blit_keyed(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h, color_t key) {
+    for (int row = 0; row < h; row++) {
+        color_t* d = dst + row * dst_stride;
+        const color_t* s = src + row * src_stride;
+        for (size_t n = (w > 0) ? w : 0; n > 0; ) {
+            size_t vl = __riscv_vsetvl_e32m8(n);
+            vuint32m8_t v = __riscv_vle32_v_u32m8(s, vl);
+            vbool4_t keep = __riscv_vmsne_vx_u32m8_b4(v, key, vl);
+            __riscv_vse32_v_u32m8_m(keep, d, v, vl);
+            d += vl;
+            s += vl;
+            n -= vl;
+        }
+    }
+}
+
+void pixel_fill16(pixel16_t* dst, size_t n, pixel16_t color) {
+    vuint16m8_t v = __riscv_vmv_v_x_u16m8(color, __riscv_vsetvlmax_e16m8());
+    while (n > 0) {
+        size_t vl = __riscv_vsetvl_e16m8(n);
+        __riscv_vse16_v_u16m8(dst, v, vl);
+        dst += vl;
+        n -= vl;
+    }
+}
+
+void pixel_fill_rect16(pixel16_t* dst, int stride, int w, int h, pixel16_t color) {
+    if (w <= 0) return;
+    for (int row = 0; row < h; row++) pixel_fill16(dst + row * stride, w, color);
+}
+
+void pixel_copy_rect16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h) {
+    for (int row = 0; row < h; row++) {
+        pixel16_t* d = dst + row * dst_stride;
+        const pixel16_t* s = src + row * src_stride;
+        for (size_t n = (w > 0) ? w : 0; n > 0; ) {
+            size_t vl = __riscv_vsetvl_e16m8(n);
+            __riscv_vse16_v_u16m8(d, __riscv_vle16_v_u16m8(s, vl), vl);
+            d += vl;
+            s += vl;
+            n -= vl;
+        }
+    }
+}
+
+void pixel_blit_keyed16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h, pixel16_t key) {
+    for (int row = 0; row < h; row++) {
+        pixel16_t* d = dst + row * dst_stride;
+        const pixel16_t* s = src + row * src_stride;
+        for (size_t n = (w > 0) ? w : 0; n > 0; ) {
+            size_t vl = __riscv_vsetvl_e16m8(n);
+            vuint16m8_t v = __riscv_vle16_v_u16m8(s, vl);
+            vbool2_t keep = __riscv_vmsne_vx_u16m8_b2(v, key, vl);
+            __riscv_vse16_v_u16m8_m(keep, d, v, vl);
+            d += vl;
+            s += vl;
+            n -= vl;
+        }
+    }
+}
+
+// Loaded 16 bits wide, widened to 32, then each channel shifted into place with its top bits repeated
+void pixel_expand565(color_t* dst, const pixel16_t* src, size_t n) {
+    while (n > 0) {
+        size_t vl = __riscv_vsetvl_e16m4(n);
+        vuint32m8_t p = __riscv_vzext_vf2_u32m8(__riscv_vle16_v_u16m4(src, vl), vl);
+        vuint32m8_t r = __riscv_vand_vx_u32m8(__riscv_vsrl_vx_u32m8(p, 11, vl), 0x1F, vl);
+        vuint32m8_t g = __riscv_vand_vx_u32m8(__riscv_vsrl_vx_u32m8(p, 5, vl), 0x3F, vl);
+        vuint32m8_t b = __riscv_vand_vx_u32m8(p, 0x1F, vl);
+        r = __riscv_vor_vv_u32m8(__riscv_vsll_vx_u32m8(r, 3, vl), __riscv_vsrl_vx_u32m8(r, 2, vl), vl);
+        g = __riscv_vor_vv_u32m8(__riscv_vsll_vx_u32m8(g, 2, vl), __riscv_vsrl_vx_u32m8(g, 4, vl), vl);
+        b = __riscv_vor_vv_u32m8(__riscv_vsll_vx_u32m8(b, 3, vl), __riscv_vsrl_vx_u32m8(b, 2, vl), vl);
+        vuint32m8_t out = __riscv_vor_vx_u32m8(__riscv_vsll_vx_u32m8(r, 16, vl), 0xFF000000, vl);
+        out = __riscv_vor_vv_u32m8(out, __riscv_vsll_vx_u32m8(g, 8, vl), vl);
+        __riscv_vse32_v_u32m8(dst, __riscv_vor_vv_u32m8(out, b, vl), vl);
+        dst += vl;
+        src += vl;
+        n -= vl;
+    }
+}
+
+#else
+
+void pixel_fill(color_t* dst, size_t n, color_t color) {
+    pixel_scalar_fill(dst, n, color);
+}
+
+void pixel_fill_rect(color_t* dst, int stride, int w, int h, color_t color) {
+    pixel_scalar_fill_rect(dst, stride, w, h, color);
+}
+
+void pixel_copy_rect(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h) {
+    pixel_scalar_copy_rect(dst, dst_stride, src, src_stride, w, h);
+}
+
+void pixel_blit_keyed(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h, color_t key) {
+    pixel_scalar_blit_keyed(dst, dst_stride, src, src_stride, w, h, key);
+}
+
+void pixel_fill16(pixel16_t* dst, size_t n, pixel16_t color) {
+    pixel_scalar_fill16(dst, n, color);
+}
+
+void pixel_fill_rect16(pixel16_t* dst, int stride, int w, int h, pixel16_t color) {
+    pixel_scalar_fill_rect16(dst, stride, w, h, color);
+}
+
+void pixel_copy_rect16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h) {
+    pixel_scalar_copy_rect16(dst, dst_stride, src, src_stride, w, h);
+}
+
+void pixel_blit_keyed16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h, pixel16_t key) {
+    pixel_scalar_blit_keyed16(dst, dst_stride, src, src_stride, w, h, key);
+}
+
+void pixel_expand565(color_t* dst, const pixel16_t* src, size_t n) {
+    pixel_scalar_expand565(dst, src, n);
+}
+
+#endif
+
+// Check and benchmark
+
+#define CHECK_PIXELS 4096
+#define CHECK_STRIDE 64
+#define CHECK_KEY 0xFF00FF00
+
+// Helper to fill both buffers with the same pseudo-random pixels (a quarter of them the key color)
+static void scramble(color_t* a, color_t* b, unsigned int seed) {
+    unsigned int x = seed * 2654435761u + 1;
+    for (int p = 0; p < CHECK_PIXELS; p++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        a[p] = b[p] = ((x & 3) == 0) ? CHECK_KEY : x;
+    }
+}
+
+// Helper to count the pixels where the two buffers differ
+static int differences(const color_t* a, const color_t* b) {
+    int n = 0;
+    for (int p = 0; p < CHECK_PIXELS; p++) n += (a[p] != b[p]);
+    return n;
+}
+
+int pixel_kernels_check(color_t* a, color_t* b) {
+    static const int sizes[] = { 0, 1, 2, 3, 7, 8, 15, 16, 17, 20, 31, 33, 63, 64 };
+    int nsizes = sizeof(sizes) / sizeof(sizes[0]);
+    int mismatches = 0;
+    for (int s = 0; s < nsizes; s++) {
+        for (int offset = 0; offset < 4; offset++) {
+            int w = sizes[s], h = 1 + (s + offset) % 9, seed = s * 4 + offset;
+            color_t* srcA = a + CHECK_PIXELS / 2 + (3 - offset);   // starts unaligned when dst is aligned
+            color_t* srcB = b + CHECK_PIXELS / 2 + (3 - offset);
+
+            scramble(a, b, seed);
+            pixel_fill(a + offset, w * h, CHECK_KEY + seed);
+            pixel_scalar_fill(b + offset, w * h, CHECK_KEY + seed);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_fill_rect(a + offset, CHECK_STRIDE, w, h, seed);
+            pixel_scalar_fill_rect(b + offset, CHECK_STRIDE, w, h, seed);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_copy_rect(a + offset, CHECK_STRIDE, srcA, w + offset, w, h);
+            pixel_scalar_copy_rect(b + offset, CHECK_STRIDE, srcB, w + offset, w, h);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_blit_keyed(a + offset, CHECK_STRIDE, srcA, CHECK_STRIDE, w, h, CHECK_KEY);
+            pixel_scalar_blit_keyed(b + offset, CHECK_STRIDE, srcB, CHECK_STRIDE, w, h, CHECK_KEY);
+            mismatches += (differences(a, b) != 0);
+
+            // the 16-bit kernels, on the same buffers seen as twice as many 16-bit pixels
+            pixel16_t* a16 = (pixel16_t*)a + offset;
+            pixel16_t* b16 = (pixel16_t*)b + offset;
+            scramble(a, b, seed);
+            pixel_fill_rect16(a16, CHECK_STRIDE, w, h, seed);
+            pixel_scalar_fill_rect16(b16, CHECK_STRIDE, w, h, seed);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_copy_rect16(a16, CHECK_STRIDE, (pixel16_t*)srcA + 1, w + offset, w, h);
+            pixel_scalar_copy_rect16(b16, CHECK_STRIDE, (pixel16_t*)srcB + 1, w + offset, w, h);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_blit_keyed16(a16, CHECK_STRIDE, (pixel16_t*)srcA, CHECK_STRIDE, w, h, CHECK_KEY & 0xFFFF);
+            pixel_scalar_blit_keyed16(b16, CHECK_STRIDE, (pixel16_t*)srcB, CHECK_STRIDE, w, h, CHECK_KEY & 0xFFFF);
+            mismatches += (differences(a, b) != 0);
+
+            scramble(a, b, seed);
+            pixel_expand565(a + offset, (pixel16_t*)srcA, w * h);
+            pixel_scalar_expand565(b + offset, (pixel16_t*)srcB, w * h);
+            mismatches += (differences(a, b) != 0);
+        }
+    }
+    return mismatches;
+}
+
+// Helper for bytes per cycle, in hundredths (printf has no floating point on the Mango Pi)
+static unsigned long hundredths(unsigned long bytes, unsigned long cycles) {
+    return cycles ? bytes * 100 / cycles : 0;
+}
+
+void pixel_kernels_bench(color_t* dst, color_t* src, int w, int h, int reps) {
+    for (int p = 0; p < w * h; p++) src[p] = (p % 3 == 0) ? CHECK_KEY : (color_t)p;
+    printf("pixel kernels (%s), %dx%d pixels x %d\n", PIXEL_KERNELS_IMPL, w, h, reps);
+    for (int kernel = 0; kernel < 6; kernel++) {
+        static const char* const names[] = { "clear", "fill rect", "copy rect", "blit keyed", "clear16", "expand565" };
+        unsigned long bytes = (unsigned long)w * h * (kernel == 4 ? sizeof(pixel16_t) : sizeof(color_t)) * reps;
+        unsigned long cycles[2];
+        for (int scalar = 0; scalar < 2; scalar++) {
+            unsigned long start = cycle_count_read();
+            for (int r = 0; r < reps; r++) {
+                switch (kernel) {
+                    case 0: scalar ? pixel_scalar_fill(dst, w * h, r) : pixel_fill(dst, w * h, r); break;
+                    case 1: scalar ? pixel_scalar_fill_rect(dst + 1, w, w - 2, h, r) : pixel_fill_rect(dst + 1, w, w - 2, h, r); break;
+                    case 2: scalar ? pixel_scalar_copy_rect(dst, w, src, w, w, h) : pixel_copy_rect(dst, w, src, w, w, h); break;
+                    case 3: scalar ? pixel_scalar_blit_keyed(dst, w, src, w, w, h, CHECK_KEY) : pixel_blit_keyed(dst, w, src, w, w, h, CHECK_KEY); break;
+                    case 4: scalar ? pixel_scalar_fill16((pixel16_t*)dst, w * h, r) : pixel_fill16((pixel16_t*)dst, w * h, r); break;
+                    case 5: scalar ? pixel_scalar_expand565(dst, (pixel16_t*)src, w * h) : pixel_expand565(dst, (pixel16_t*)src, w * h); break;
+                }
+            }
+            cycles[scalar] = cycle_count_read() - start;
+        }
+        unsigned long rate = hundredths(bytes, cycles[0]), scalarRate = hundredths(bytes, cycles[1]);
+        printf("%-10s %3lu.%02lu bytes/cycle (scalar %lu.%02lu)\n", names[kernel], rate / 100, rate % 100,
+               scalarRate / 100, scalarRate % 100);
+    }
+}
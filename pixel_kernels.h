@@ -0,0 +1,86 @@
+#ifndef _PIXEL_KERNELS_H
+#define _PIXEL_KERNELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "gl.h"
+
+// Pixel kernels: the inner loops of the game's drawing (clears, rect fills, rect copies, keyed tile
+// blits) over 32-bit pixels, plus the 16-bit (RGB565) ones of render.h's 16-bit screens and the expansion
+// of those to 32 bits for display. Strides are in pixels. Built with the RISC-V vector extension enabled
+// (an ARCH with v or xtheadvector: not yet checked on the board, so the Makefile's is scalar) they run
+// on the vector unit; otherwise, and always as pixel_scalar_*, they are plain C with 64-bit stores. Both
+// give the same pixels: pixel_kernels_check compares them (in a scalar build, the scalar kernels with
+// themselves).
+
+#if defined(__riscv_vector) || defined(__riscv_xtheadvector)
+#define PIXEL_KERNELS_RVV 1
+#define PIXEL_KERNELS_IMPL "rvv"
+#else
+#define PIXEL_KERNELS_RVV 0
+#define PIXEL_KERNELS_IMPL "scalar"
+#endif
+
+// A 64-bit word of pixels, for the loops that move 64 bits per store (may_alias: it's written over
+// color_t and pixel16_t pixels). The first pixel goes in the low bits.
+typedef uint64_t __attribute__((may_alias)) pixel_pair_t;
+
+static inline pixel_pair_t pixel_pair(color_t p0, color_t p1) {
+    return ((pixel_pair_t)p1 << 32) | p0;
+}
+
+// Turns the vector unit on, in a build with the vector kernels: the C906 comes out of reset with it off
+// (mstatus.VS = 0), and the first vector instruction would trap as illegal. Call it first thing in main,
+// as the compiler may put vector instructions anywhere in such a build. Does nothing otherwise
+void pixel_kernels_init(void);
+
+void pixel_fill(color_t* dst, size_t n, color_t color);
+void pixel_fill_rect(color_t* dst, int stride, int w, int h, color_t color);
+void pixel_copy_rect(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h);
+// copies the w x h tile, except its pixels that are key (those leave dst as it was)
+void pixel_blit_keyed(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h, color_t key);
+
+// RGB565 pixels (5 bits red, 6 green, 5 blue), and their conversion from and to color_t (the low bits
+// repeat the high ones, so white stays white and black black)
+typedef uint16_t pixel16_t;
+
+static inline pixel16_t pixel_to_565(color_t c) {
+    return ((c >> 8) & 0xF800) | ((c >> 5) & 0x07E0) | ((c >> 3) & 0x001F);
+}
+
+static inline color_t pixel_from_565(pixel16_t p) {
+    unsigned int r = (p >> 11) & 0x1F, g = (p >> 5) & 0x3F, b = p & 0x1F;
+    return 0xFF000000 | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+}
+
+static inline pixel_pair_t pixel_quad16(pixel16_t p0, pixel16_t p1, pixel16_t p2, pixel16_t p3) {
+    return ((pixel_pair_t)p3 << 48) | ((pixel_pair_t)p2 << 32) | ((pixel_pair_t)p1 << 16) | p0;
+}
+
+void pixel_fill16(pixel16_t* dst, size_t n, pixel16_t color);
+void pixel_fill_rect16(pixel16_t* dst, int stride, int w, int h, pixel16_t color);
+void pixel_copy_rect16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h);
+void pixel_blit_keyed16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h, pixel16_t key);
+void pixel_expand565(color_t* dst, const pixel16_t* src, size_t n);     // n pixels, each pixel_from_565
+
+void pixel_scalar_fill(color_t* dst, size_t n, color_t color);
+void pixel_scalar_fill_rect(color_t* dst, int stride, int w, int h, color_t color);
+void pixel_scalar_copy_rect(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h);
+void pixel_scalar_blit_keyed(color_t* dst, int dst_stride, const color_t* src, int src_stride, int w, int h, color_t key);
+void pixel_scalar_fill16(pixel16_t* dst, size_t n, pixel16_t color);
+void pixel_scalar_fill_rect16(pixel16_t* dst, int stride, int w, int h, pixel16_t color);
+void pixel_scalar_copy_rect16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h);
+void pixel_scalar_blit_keyed16(pixel16_t* dst, int dst_stride, const pixel16_t* src, int src_stride, int w, int h, pixel16_t key);
+void pixel_scalar_expand565(color_t* dst, const pixel16_t* src, size_t n);
+
+// Runs every kernel and its scalar version on the same inputs (odd sizes, unaligned starts, strides,
+// keyed pixels) and compares the results. a and b are scratch buffers of at least 4096 pixels each.
+// Returns the number of mismatches (0 = identical)
+int pixel_kernels_check(color_t* a, color_t* b);
+
+// Times each kernel (and its scalar version) reps times on a w x h rect of the w * h pixel buffers
+// dst and src, and prints bytes written per cycle (cycle_count.h)
+void pixel_kernels_bench(color_t* dst, color_t* src, int w, int h, int reps);
+
+#endif
@@ -0,0 +1,101 @@
+/* profiler.c
+ * Module for a sampling profiler: a timer interrupt records where the program was (the interrupted pc)
+ * Author: Aditi (aditijb@stanford.edu)
+ * Timer registers are from the D1 user manual (3.6 Timer), since the cs107e libraries only drive the hstimers
+ */
+
+#include "profiler.h"
+#include "interrupts.h"
+#include "isr_stats.h"
+#include "printf.h"
+#include "strings.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define TIMER_BASE 0x02050000
+#define INTERRUPT_SOURCE_TIMER0 ((interrupt_source_t)75) // D1 PLIC source number for TIMER0
+#define TIMER_CLOCK_HZ 24000000                          // OSC24M
+
+// TIMER0 control bits
+#define TMR_EN (1 << 0)
+#define TMR_RELOAD (1 << 1)
+#define TMR_CLK_SRC_OSC24M (1 << 2)
+
+static volatile struct {
+    uint32_t irq_en ;       // 0x00
+    uint32_t irq_sta ;      // 0x04, write 1 to clear
+    uint32_t reserved[2] ;
+    uint32_t tmr0_ctrl ;    // 0x10
+    uint32_t tmr0_intv ;    // 0x14
+    uint32_t tmr0_cur ;     // 0x18
+} *const timer = (void *)TIMER_BASE ;
+
+static struct {
+    unsigned int buckets[PROFILER_NBUCKETS] ;
+    unsigned long samples ;
+    unsigned long outside ; // samples outside the histogram's address range
+    int rate_hz ;
+} profile ;
+
+// `handle_sample`
+// handler for TIMER0: pc is where the program was when the timer fired
+static void handle_sample(uintptr_t pc, void *aux_data) {
+    timer->irq_sta = 1 ; // clear TIMER0 pending
+
+    uintptr_t offset = pc - PROFILER_TEXT_BASE ; // wraps to huge for pc below the base
+    if (offset < (uintptr_t)PROFILER_NBUCKETS * PROFILER_BUCKET_SIZE) profile.buckets[offset / PROFILER_BUCKET_SIZE]++ ;
+    else profile.outside++ ;
+    profile.samples++ ;
+}
+
+// 'profiler_init'
+// TIMER0 runs continuously off the 24MHz oscillator and reloads itself, so the handler only clears it
+void profiler_init(int rate_hz) {
+    if (rate_hz <= 0) rate_hz = 1 ;
+    profile.rate_hz = rate_hz ;
+    profiler_reset() ;
+
+    timer->tmr0_ctrl = 0 ;
+    timer->tmr0_intv = TIMER_CLOCK_HZ / rate_hz ;
+    timer->tmr0_ctrl = TMR_CLK_SRC_OSC24M ;  // prescale 1, continuous mode
+    timer->irq_sta = 1 ;
+
+    isr_stats_register_handler(INTERRUPT_SOURCE_TIMER0, handle_sample, NULL, "profiler") ;
+    interrupts_enable_source(INTERRUPT_SOURCE_TIMER0) ;
+}
+
+// 'profiler_start'
+// reload the interval and let the timer run
+void profiler_start(void) {
+    timer->tmr0_ctrl |= TMR_RELOAD ;
+    while (timer->tmr0_ctrl & TMR_RELOAD) ; // reload bit self-clears once the interval is loaded
+    timer->irq_en |= 1 ;
+    timer->tmr0_ctrl |= TMR_EN ;
+}
+
+// 'profiler_stop'
+// timer stops counting; histogram is kept
+void profiler_stop(void) {
+    timer->tmr0_ctrl &= ~TMR_EN ;
+    timer->irq_en &= ~1 ;
+    timer->irq_sta = 1 ;
+}
+
+// 'profiler_reset'
+// clears the histogram
+void profiler_reset(void) {
+    memset(profile.buckets, 0, sizeof(profile.buckets)) ;
+    profile.samples = 0 ;
+    profile.outside = 0 ;
+}
+
+// 'profiler_dump'
+// format read by tools/profile_symbolize.py: a header line, one "address count" line per bucket, END
+void profiler_dump(void) {
+    printf("\nPROFILE base=0x%x bucket=%d rate=%d samples=%ld outside=%ld\n",
+           PROFILER_TEXT_BASE, PROFILER_BUCKET_SIZE, profile.rate_hz, profile.samples, profile.outside) ;
+    for (int i = 0; i < PROFILER_NBUCKETS; i++) {
+        if (profile.buckets[i] != 0) printf("0x%x %d\n", PROFILER_TEXT_BASE + i * PROFILER_BUCKET_SIZE, profile.buckets[i]) ;
+    }
+    printf("END\n") ;
+}
@@ -0,0 +1,42 @@
+/* profiler.h
+ * Module for a sampling profiler: a timer interrupt records where the program was (the interrupted pc)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * Both hstimers are already used by the buzzer (passive_buzz_intr), so the profiler runs off the D1's
+ * general-purpose TIMER0. Samples go into a fixed histogram of PROFILER_BUCKET_SIZE-byte address buckets
+ * starting at PROFILER_TEXT_BASE. profiler_dump prints the histogram over uart; save the output and run
+ *      tools/profile_symbolize.py dump.txt myprogram.elf
+ * on the computer for a flat profile by function.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#define PROFILER_TEXT_BASE 0x40000000 // where memmap.ld puts .text
+#define PROFILER_BUCKET_SIZE 32       // bytes of code per histogram bucket (8 instructions)
+#define PROFILER_NBUCKETS 8192        // covers 256KB of code
+
+/* 'profiler_init'
+ * @param int rate_hz - samples per second (e.g. 1000). odd rates keep samples from lining up with the game loop
+ * @functionality - sets up the sampling timer and clears the histogram. interrupts must be initialized
+ *                  (interrupts_init) first; sampling starts with profiler_start
+ */
+void profiler_init(int rate_hz) ;
+
+/* 'profiler_start' / 'profiler_stop'
+ * @functionality - start/stop taking samples. the histogram is kept between stop and start
+ */
+void profiler_start(void) ;
+void profiler_stop(void) ;
+
+/* 'profiler_reset'
+ * @functionality - clears the histogram
+ */
+void profiler_reset(void) ;
+
+/* 'profiler_dump'
+ * @functionality - prints the non-empty histogram buckets over uart, between PROFILE and END lines
+ */
+void profiler_dump(void) ;
+
+#endif
@@ -6,42 +6,79 @@
 * a random bag! 
 * Citation: Julie, for giving us this awesome question on our CS106B exam in Fall 2023,
 * while inspired my O(1) logic here! :)
+*
+* Randomness comes from a seeded PCG32 generator (https://www.pcg-random.org, pcg32_random_r),
+* so the same seed gives the same sequence of pieces on every run -- on the Mango Pi or on a computer.
+* Each bag holds one of each of the 7 pieces and is refilled with a Fisher-Yates shuffle.
+* All state lives in the random_bag_t passed in, so every game gets its own bag.
 */
 
 #include "random_bag.h"
 #include "timer.h"
-#define BAG_SIZE 28
-#define NUM_ELEMS 7
-
-static struct {
-    int random_bag[BAG_SIZE];
-    int size;
-} rand_bag;
-
-// Required init
-void random_bag_init(void) {
-    for (int i = 0; i < BAG_SIZE; i++) {
-        rand_bag.random_bag[i] = i % NUM_ELEMS;
-    }
-    rand_bag.size = BAG_SIZE;
+
+#define PCG_MULTIPLIER 6364136223846793005ULL
+#define PCG_INCREMENT 1442695040888963407ULL  // any odd constant selects a stream
+
+// Steps the generator and returns 32 random bits
+static uint32_t pcg32_next(random_bag_t* rand_bag) {
+    uint64_t old = rand_bag->state;
+    rand_bag->state = old * PCG_MULTIPLIER + PCG_INCREMENT;
+    uint32_t xorshifted = ((old >> 18) ^ old) >> 27;
+    uint32_t rot = old >> 59;
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
 }
 
-bool random_bag_isEmpty(void) {
-    return (rand_bag.size == 0);
+// Returns a random number in [0, range) with a multiply and shift instead of a (slow, biased) modulo.
+// Never rejects/retries, so every call costs the same; bias is at most range / 2^32 (nothing for 7 pieces!)
+static int random_below(random_bag_t* rand_bag, int range) {
+    return (int)(((uint64_t)pcg32_next(rand_bag) * (uint32_t)range) >> 32);
 }
 
-// Returns randomly chosen element (as a number ranging from 0 to NUM_ELEMS) from random bag
-// If bag is empty, the random bag is replenished before an element is chosen.
-int random_bag_choose(void) {
-    if (random_bag_isEmpty()) {
-        random_bag_init();      // replenish random bag by resetting state
+// Required init: seeds the bag from the timer, so every game gets different pieces
+void random_bag_init(random_bag_t* rand_bag) {
+    random_bag_set_seed(rand_bag, (uint32_t)timer_get_ticks());
+}
+
+// Restarts the generator from seed and empties the bag; the sequence of chosen elements
+// that follows depends only on the seed
+void random_bag_set_seed(random_bag_t* rand_bag, uint32_t seed) {
+    rand_bag->seed = seed;
+    rand_bag->state = 0;
+    pcg32_next(rand_bag);
+    rand_bag->state += seed;
+    pcg32_next(rand_bag);
+    rand_bag->size = 0;
+}
+
+uint32_t random_bag_get_seed(const random_bag_t* rand_bag) {
+    return rand_bag->seed;
+}
+
+bool random_bag_isEmpty(const random_bag_t* rand_bag) {
+    return (rand_bag->size == 0);
+}
+
+// Refills the bag with one of each element, in Fisher-Yates shuffled order
+static void random_bag_refill(random_bag_t* rand_bag) {
+    for (int i = 0; i < RANDOM_BAG_NUM_ELEMS; i++) {
+        rand_bag->random_bag[i] = i;
     }
-    int randInd = timer_get_ticks() % rand_bag.size;
-    int chosen = rand_bag.random_bag[randInd];
-    // Shifting of last element in random_bag array to ensure all elements are colocated in array and performance is optimized!
-    if (randInd != (rand_bag.size - 1)) {
-        rand_bag.random_bag[randInd] = rand_bag.random_bag[rand_bag.size - 1];
+    for (int i = RANDOM_BAG_NUM_ELEMS - 1; i > 0; i--) {
+        int j = random_below(rand_bag, i + 1);
+        int tmp = rand_bag->random_bag[i];
+        rand_bag->random_bag[i] = rand_bag->random_bag[j];
+        rand_bag->random_bag[j] = tmp;
+    }
+    rand_bag->size = RANDOM_BAG_NUM_ELEMS;
+}
+
+// Returns randomly chosen element (as a number ranging from 0 to RANDOM_BAG_NUM_ELEMS) from random bag
+// If bag is empty, the random bag is replenished before an element is chosen.
+int random_bag_choose(random_bag_t* rand_bag) {
+    if (random_bag_isEmpty(rand_bag)) {
+        random_bag_refill(rand_bag);    // replenish random bag with a freshly shuffled set
     }
-    rand_bag.size--;
-    return chosen;
-}   
\ No newline at end of file
+    // bag is already shuffled, so just take the last element -- O(1) and all elements stay colocated in array!
+    rand_bag->size--;
+    return rand_bag->random_bag[rand_bag->size];
+}   
@@ -2,10 +2,23 @@
 #define _RAND_BAG_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
-void random_bag_init(void);
-bool random_bag_isEmpty(void);
-int random_bag_choose(void);
+#define RANDOM_BAG_NUM_ELEMS 7
+
+typedef struct {
+    int random_bag[RANDOM_BAG_NUM_ELEMS];
+    int size;           // elements left in the bag; taken from the end of the array
+    uint64_t state;     // PCG32 state
+    uint32_t seed;
+} random_bag_t;
+
+void random_bag_init(random_bag_t* rand_bag);
+bool random_bag_isEmpty(const random_bag_t* rand_bag);
+int random_bag_choose(random_bag_t* rand_bag);
+
+// Seeding: the same seed always gives the same sequence of chosen elements (for replays/benchmarks)
+void random_bag_set_seed(random_bag_t* rand_bag, uint32_t seed);
+uint32_t random_bag_get_seed(const random_bag_t* rand_bag);
 
 #endif
- 
@@ -11,11 +11,11 @@
 #include "uart.h"
 #include "LSD6DS33.h"
 #include "i2c.h"
-#include "ringbuffer.h"
 #include "remote.h"
 #include <stddef.h>
 #include "music.h"
 #include "passive_buzz_intr.h"
+#include "isr_stats.h"
 
 static remote_t remote ;
 
@@ -25,17 +25,15 @@ static void handle_button(uintptr_t pc, void *aux_data) {
     gpio_interrupt_clear(remote.button) ;
 
     remote_t *rem = (remote_t *)aux_data ;
-    // don't check whether it was added; it's trivial and unlikely that the queue overfills and branching takes time
-    rb_enqueue(rem->rb, 1) ; 
+    rem->presses++ ; // can't overflow in practice, and the difference stays right even if it wraps
 }
 
 // 'remote_is_button_press'
 // checks if there are presses in the queue
 bool remote_is_button_press(void) {
-    int k = 0 ;
-    if (!(rb_empty(remote.rb))) {
+    if (remote.presses != remote.handled) {
         servo_vibrate_milli_sec(100) ;
-        rb_dequeue(remote.rb, &k) ;
+        remote.handled++ ;
         return true ;
     }
     return false ;
@@ -51,7 +49,7 @@ void remote_init(gpio_id_t servo_id, gpio_id_t button_id, gpio_id_t buzzer_id, i
     remote.servo = servo_id ;    
     servo_init(servo_id) ;
 
-    remote.rb = rb_new() ;
+    remote.presses = remote.handled = 0 ;
 
     // accelerometer init
     i2c_init();
@@ -62,7 +60,7 @@ void remote_init(gpio_id_t servo_id, gpio_id_t button_id, gpio_id_t buzzer_id, i
 
     gpio_interrupt_init() ;
     gpio_interrupt_config(remote.button, GPIO_INTERRUPT_POSITIVE_EDGE, true) ; // if pressed
-    gpio_interrupt_register_handler(remote.button, handle_button, &remote) ;
+    isr_stats_register_gpio_handler(remote.button, handle_button, &remote, "button") ;
     gpio_interrupt_enable(remote.button) ;
 
 }
@@ -12,18 +12,20 @@
 #ifndef REMOTE_H
 #define REMOTE_H
 
-#include "ringbuffer.h"
 #include "gpio.h"
+#include <stdbool.h>
 
 /* remote_t struct
  * stores gpio id's of each component 
- * stores rb to store interrupts registered from button presses 
+ * counts button presses registered by the interrupt handler (presses - handled = presses waiting)
+ *     no heap-allocated queue needed: a press carries no data, so two counters are the whole queue
  */
 typedef struct {
     gpio_id_t servo ; 
     gpio_id_t button ;
     gpio_id_t buzzer ;
-    rb_t *rb ;
+    volatile unsigned int presses ; // only written by the interrupt handler
+    unsigned int handled ;          // only written by remote_is_button_press
 } remote_t;
 
 /* remote_init
@@ -0,0 +1,373 @@
+/* render.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The render.c module holds the drawing primitives game_update.c builds its screens from: rects, bevel
+* outlines, text and blits written straight into the framebuffer (by the pixel kernels, 32 or 16 bits
+* per pixel), and a per-frame
+* list of draw commands that is trimmed (covered commands culled, touching rects merged, scanline
+* order) before it is drawn.
+*/
+
+#include "render.h"
+#include <stddef.h>
+#include "fb.h"
+#include "font.h"
+#include "strings.h"
+#include "pixel_kernels.h"
+
+// The screen render_init set up. An RGB565 one is drawn in pixels16 (only there with RGB565_FRAMES)
+static struct {
+    int width, height;
+    render_format_t format;
+#if RGB565_FRAMES
+    pixel16_t pixels16[RENDER_RGB565_MAX_PIXELS];
+#endif
+} screen;
+
+// Helper to get the RGB565 frame (NULL in a build without one, where nothing draws in RGB565)
+static pixel16_t* frame16(void) {
+#if RGB565_FRAMES
+    return screen.pixels16;
+#else
+    return NULL;
+#endif
+}
+
+// Helper to get the 32-bit framebuffer's draw buffer (NULL if there is no 32-bit one to write to)
+static color_t* drawBuffer(void) {
+    color_t* buf = fb_get_draw_buffer();
+    return (buf == NULL || fb_get_depth() != sizeof(color_t)) ? NULL : buf;
+}
+
+// Helper to check if drawing goes to the RGB565 frame: it has to be the screen on show still
+static bool rgb565(void) {
+    return RGB565_FRAMES && screen.format == RENDER_RGB565 && drawBuffer() != NULL && fb_get_width() == screen.width
+        && fb_get_height() == screen.height;
+}
+
+// gl_init (which reallocates the framebuffer) only runs when the screen changes size: a new game, or the
+// interlude, on the screen that's already there keeps its buffers
+void render_init(int width, int height, render_format_t format) {
+    if (drawBuffer() == NULL || fb_get_width() != width || fb_get_height() != height) {
+        gl_init(width, height, GL_DOUBLEBUFFER);
+    }
+    screen.width = width;
+    screen.height = height;
+    screen.format = (RGB565_FRAMES && (size_t)width * height <= RENDER_RGB565_MAX_PIXELS) ? format : RENDER_ARGB8888;
+}
+
+render_format_t render_get_format(void) {
+    return rgb565() ? RENDER_RGB565 : RENDER_ARGB8888;
+}
+
+void* render_get_draw_buffer(void) {
+    return rgb565() ? (void*)frame16() : (void*)drawBuffer();
+}
+
+void render_show(void) {
+    if (rgb565()) pixel_expand565(drawBuffer(), frame16(), (size_t)screen.width * screen.height);
+    gl_swap_buffer();
+}
+
+// Helper to cut the w x h rect at (*x, *y) down to the part on screen, moving *x, *y to its new top
+// left corner. Returns false if none of it is on screen
+static bool clip(int* x, int* y, int* w, int* h) {
+    int right = *x + *w, bottom = *y + *h;
+    if (*x < 0) *x = 0;
+    if (*y < 0) *y = 0;
+    if (right > fb_get_width()) right = fb_get_width();
+    if (bottom > fb_get_height()) bottom = fb_get_height();
+    *w = right - *x;
+    *h = bottom - *y;
+    return *w > 0 && *h > 0;
+}
+
+void render_clear(color_t color) {
+    color_t* buf = drawBuffer();
+    size_t npixels = (size_t)fb_get_width() * fb_get_height();
+    if (buf == NULL) gl_clear(color);
+    else if (rgb565()) pixel_fill16(frame16(), npixels, pixel_to_565(color));
+    else pixel_fill(buf, npixels, color);
+}
+
+void render_rect(int x, int y, int w, int h, color_t color) {
+    color_t* buf = drawBuffer();
+    int width = fb_get_width();
+    if (buf == NULL) gl_draw_rect(x, y, w, h, color);
+    else if (!clip(&x, &y, &w, &h)) return;
+    else if (rgb565()) pixel_fill_rect16(frame16() + y * width + x, width, w, h, pixel_to_565(color));
+    else pixel_fill_rect(buf + y * width + x, width, w, h, color);
+}
+
+/* Glyph atlas: the font's characters expanded to pixels (in the screen's format) in one pair of colors,
+each glyph a block that is drawn by copying it row by row. A glyph is expanded the first time it's
+drawn; a different pair of colors (or format) starts the atlas over.
+*/
+#define ATLAS_FIRST ' '
+#define ATLAS_GLYPHS 95                 // ' ' .. '~'
+#define ATLAS_GLYPH_PIXELS (16 * 20)    // biggest glyph it holds (libmango's are 14 x 16)
+
+static struct {
+    render_format_t format;
+    color_t fg, bg;
+    bool ready[ATLAS_GLYPHS];
+    union {
+        color_t pixels[ATLAS_GLYPHS][ATLAS_GLYPH_PIXELS];
+        pixel16_t pixels16[ATLAS_GLYPHS][ATLAS_GLYPH_PIXELS];
+    };
+} atlas;
+
+// Helper to check if text can be drawn from the atlas (there's a draw buffer, and the glyphs fit)
+static bool atlasUsable(void) {
+    return drawBuffer() != NULL && font_get_glyph_size() <= ATLAS_GLYPH_PIXELS;
+}
+
+// Helper to get ch's glyph block in fg on bg, expanding it first if needed. NULL if the font has no ch
+static const void* atlasGlyph(char ch, color_t fg, color_t bg) {
+    if (ch < ATLAS_FIRST || ch >= ATLAS_FIRST + ATLAS_GLYPHS) return NULL;
+    render_format_t format = render_get_format();
+    if (atlas.format != format || atlas.fg != fg || atlas.bg != bg) {
+        memset(atlas.ready, 0, sizeof(atlas.ready));
+        atlas.format = format;
+        atlas.fg = fg;
+        atlas.bg = bg;
+    }
+    int index = ch - ATLAS_FIRST;
+    if (!atlas.ready[index]) {
+        unsigned char glyph[ATLAS_GLYPH_PIXELS];
+        if (!font_get_glyph(ch, glyph, sizeof(glyph))) return NULL;
+        for (int p = 0; p < font_get_glyph_size(); p++) {
+            color_t color = glyph[p] ? fg : bg;
+            if (format == RENDER_RGB565) atlas.pixels16[index][p] = pixel_to_565(color);
+            else atlas.pixels[index][p] = color;
+        }
+        atlas.ready[index] = true;
+    }
+    return (format == RENDER_RGB565) ? (const void*)atlas.pixels16[index] : (const void*)atlas.pixels[index];
+}
+
+// Atlas glyphs in color on a key color (any other color), blitted with the key pixels skipped
+void render_text(int x, int y, const char* str, color_t color) {
+    if (atlasUsable()) {
+        color_t key = color ^ 0x00FFFFFF;   // (differs in every bit, in RGB565 too)
+        int gw = font_get_glyph_width(), gh = font_get_glyph_height();
+        for (; *str != '\0'; str++, x += gw) {
+            const void* glyph = atlasGlyph(*str, color, key);
+            if (glyph != NULL) render_blit_keyed(x, y, gw, gh, glyph, key);
+        }
+        return;
+    }
+    if (!rgb565()) {
+        gl_draw_string(x, y, str, color);
+        return;
+    }
+    // glyphs too big for the atlas: their pixels written one by one (gl_draw_string's, in 16 bits)
+    int gw = font_get_glyph_width(), gh = font_get_glyph_height();
+    unsigned char glyph[font_get_glyph_size()];
+    pixel16_t pixel = pixel_to_565(color);
+    pixel16_t* frame = frame16();
+    for (; *str != '\0'; str++, x += gw) {
+        if (!font_get_glyph(*str, glyph, sizeof(glyph))) continue;
+        for (int row = 0; row < gh; row++) {
+            if (y + row < 0 || y + row >= screen.height) continue;
+            for (int col = 0; col < gw; col++) {
+                if (glyph[row * gw + col] && x + col >= 0 && x + col < screen.width) {
+                    frame[(y + row) * screen.width + x + col] = pixel;
+                }
+            }
+        }
+    }
+}
+
+// Whole character cells: each atlas glyph copied as is (cells the font has no glyph for are left bg)
+void render_text_blit(int x, int y, const char* str, color_t fg, color_t bg) {
+    int gw = font_get_glyph_width(), gh = font_get_glyph_height();
+    if (!atlasUsable()) {
+        render_rect(x, y, strlen(str) * gw, gh, bg);
+        render_text(x, y, str, fg);
+        return;
+    }
+    for (; *str != '\0'; str++, x += gw) {
+        const void* glyph = atlasGlyph(*str, fg, bg);
+        if (glyph != NULL) render_blit(x, y, gw, gh, glyph);
+        else render_rect(x, y, gw, gh, bg);
+    }
+}
+
+void render_blit(int x, int y, int w, int h, const void* pixels) {
+    int x0 = x, y0 = y, stride = w, width = fb_get_width();
+    if (drawBuffer() == NULL || !clip(&x, &y, &w, &h)) return;
+    int skip = (y - y0) * stride + (x - x0);    // pixels clipped off before the first one drawn
+    if (rgb565()) {
+        pixel_copy_rect16(frame16() + y * width + x, width, (const pixel16_t*)pixels + skip, stride, w, h);
+    } else {
+        pixel_copy_rect(drawBuffer() + y * width + x, width, (const color_t*)pixels + skip, stride, w, h);
+    }
+}
+
+void render_blit_keyed(int x, int y, int w, int h, const void* pixels, color_t key) {
+    int x0 = x, y0 = y, stride = w, width = fb_get_width();
+    if (drawBuffer() == NULL || !clip(&x, &y, &w, &h)) return;
+    int skip = (y - y0) * stride + (x - x0);
+    if (rgb565()) {
+        pixel_blit_keyed16(frame16() + y * width + x, width, (const pixel16_t*)pixels + skip, stride, w, h,
+                           pixel_to_565(key));
+    } else {
+        pixel_blit_keyed(drawBuffer() + y * width + x, width, (const color_t*)pixels + skip, stride, w, h, key);
+    }
+}
+
+// With BEVEL_SPANS: top and bottom rows as spans, the columns between as 1-pixel wide rects. Otherwise
+// (and without a draw buffer to write to) four gl_draw_lines, as the bevels were always drawn. The spans
+// match the host's stand-in gl_draw_line (host/golden.txt, host/game-spans), which isn't libmango's
+// anti-aliased one: test_bevel_frames compares them with that on the board. An RGB565 frame has no
+// gl_draw_line to draw in, so it always gets the spans
+void render_frame(int x, int y, int w, int h, color_t color) {
+    if (drawBuffer() == NULL || (!BEVEL_SPANS && !rgb565())) {
+        gl_draw_line(x, y, x + w - 1, y, color);
+        gl_draw_line(x, y, x, y + h - 1, color);
+        gl_draw_line(x + w - 1, y + h - 1, x + w - 1, y, color);
+        gl_draw_line(x + w - 1, y + h - 1, x, y + h - 1, color);
+        return;
+    }
+    render_rect(x, y, w, 1, color);
+    if (h > 1) render_rect(x, y + h - 1, w, 1, color);
+    render_rect(x, y + 1, 1, h - 2, color);
+    if (w > 1) render_rect(x + w - 1, y + 1, 1, h - 2, color);
+}
+
+typedef enum { CMD_RECT, CMD_FRAME, CMD_TEXT, CMD_BLIT } cmd_kind_t;
+
+typedef struct {
+    cmd_kind_t kind;
+    int x, y, w, h;             // what it draws on (for text, the cells of its characters)
+    color_t color;
+    const void* data;           // CMD_TEXT: string in the text pool, CMD_BLIT: pixels
+} cmd_t;
+
+static struct {
+    cmd_t cmds[RENDER_LIST_CAPACITY];
+    int count;
+    char text[RENDER_LIST_TEXT];
+    int textUsed;
+    render_stats_t stats;
+} list;
+
+// Helper to check if commands a and b draw on any of the same pixels
+static bool overlaps(const cmd_t* a, const cmd_t* b) {
+    return a->x < b->x + b->w && b->x < a->x + a->w && a->y < b->y + b->h && b->y < a->y + a->h;
+}
+
+// Helper to check if command a is drawn over completely by b (which has to be solid)
+static bool covers(const cmd_t* b, const cmd_t* a) {
+    if (b->kind != CMD_RECT && b->kind != CMD_BLIT) return false;
+    return b->x <= a->x && b->y <= a->y && a->x + a->w <= b->x + b->w && a->y + a->h <= b->y + b->h;
+}
+
+static void record(cmd_kind_t kind, int x, int y, int w, int h, color_t color, const void* data) {
+    if (w <= 0 || h <= 0) return;
+    if (list.count == RENDER_LIST_CAPACITY) render_list_flush();
+    list.cmds[list.count++] = (cmd_t){ kind, x, y, w, h, color, data };
+    list.stats.recorded++;
+}
+
+void render_list_rect(int x, int y, int w, int h, color_t color) {
+    record(CMD_RECT, x, y, w, h, color, NULL);
+}
+
+void render_list_frame(int x, int y, int w, int h, color_t color) {
+    record(CMD_FRAME, x, y, w, h, color, NULL);
+}
+
+void render_list_text(int x, int y, const char* str, color_t color) {
+    size_t len = strlen(str);
+    if (list.count == RENDER_LIST_CAPACITY || list.textUsed + len + 1 > RENDER_LIST_TEXT) render_list_flush();
+    if (len + 1 > RENDER_LIST_TEXT) len = RENDER_LIST_TEXT - 1;
+    char* copy = list.text + list.textUsed;
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+    list.textUsed += len + 1;
+    record(CMD_TEXT, x, y, len * gl_get_char_width(), gl_get_char_height(), color, copy);
+}
+
+void render_list_blit(int x, int y, int w, int h, const void* pixels) {
+    record(CMD_BLIT, x, y, w, h, 0, pixels);
+}
+
+// Helper to drop the commands a later solid command draws over completely
+static void cull(void) {
+    int kept = 0;
+    for (int i = 0; i < list.count; i++) {
+        bool covered = false;
+        for (int j = i + 1; j < list.count && !covered; j++) covered = covers(&list.cmds[j], &list.cmds[i]);
+        if (covered) list.stats.culled++;
+        else list.cmds[kept++] = list.cmds[i];
+    }
+    list.count = kept;
+}
+
+#define MERGE_LOOKBACK 8    // how many commands back a rect looks for a neighbor to merge into
+
+// Helper to merge each rect into an earlier same-color rect it lines up with side by side (or one above
+// the other), if nothing drawn in between touches it -- it can then just as well be drawn earlier
+static void merge(void) {
+    int kept = 0;
+    for (int i = 0; i < list.count; i++) {
+        cmd_t* b = &list.cmds[i];
+        bool merged = false;
+        for (int k = kept - 1; b->kind == CMD_RECT && k >= 0 && k >= kept - MERGE_LOOKBACK; k--) {
+            cmd_t* a = &list.cmds[k];
+            if (a->kind == CMD_RECT && a->color == b->color) {
+                if (a->y == b->y && a->h == b->h && a->x + a->w == b->x) a->w += b->w;
+                else if (a->x == b->x && a->w == b->w && a->y + a->h == b->y) a->h += b->h;
+                else if (!overlaps(a, b)) continue;
+                else break;
+                merged = true;
+                break;
+            }
+            if (overlaps(a, b)) break;
+        }
+        if (merged) list.stats.merged++;
+        else list.cmds[kept++] = *b;
+    }
+    list.count = kept;
+}
+
+// Helper to put the commands in scanline order (by top row). Insertion sort that only ever swaps
+// neighbors that don't overlap, so overlapping commands keep the order they were recorded in
+static void sortByScanline(void) {
+    for (int i = 1; i < list.count; i++) {
+        for (int k = i; k > 0; k--) {
+            cmd_t* a = &list.cmds[k - 1];
+            cmd_t* b = &list.cmds[k];
+            if (a->y <= b->y || overlaps(a, b)) break;
+            cmd_t tmp = *a;
+            *a = *b;
+            *b = tmp;
+        }
+    }
+}
+
+void render_list_flush(void) {
+    cull();
+    merge();
+    sortByScanline();
+    for (int i = 0; i < list.count; i++) {
+        const cmd_t* cmd = &list.cmds[i];
+        switch (cmd->kind) {
+            case CMD_RECT: render_rect(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color); break;
+            case CMD_FRAME: render_frame(cmd->x, cmd->y, cmd->w, cmd->h, cmd->color); break;
+            case CMD_TEXT: render_text(cmd->x, cmd->y, cmd->data, cmd->color); break;
+            case CMD_BLIT: render_blit(cmd->x, cmd->y, cmd->w, cmd->h, cmd->data); break;
+        }
+    }
+    list.stats.issued += list.count;
+    list.stats.flushes++;
+    list.count = 0;
+    list.textUsed = 0;
+}
+
+render_stats_t render_list_get_stats(void) {
+    return list.stats;
+}
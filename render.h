@@ -0,0 +1,75 @@
+#ifndef _RENDER_H
+#define _RENDER_H
+
+#include <stdbool.h>
+#include "gl.h"
+
+// Drawing primitives for the game screens, on top of gl/fb.
+//
+// render_init sets up a double-buffered screen in either pixel format, reusing the framebuffer if it's
+// already that size. An RGB565 screen is drawn 16 bits per pixel, into a frame of its own that
+// render_show expands into the framebuffer (libmango's is always 32-bit) just before showing it. Drawing
+// into that frame moves half the bytes, but the expansion reads all of it and writes the whole 32-bit
+// frame again, so a frame costs more than drawing ARGB8888 straight into the framebuffer: RGB565 only
+// pays off with a 16-bit framebuffer to show, which libmango doesn't have. Once another module sets up
+// the framebuffer (a different size), drawing goes back to ARGB8888. The 16-bit frame is only built in
+// with RGB565_FRAMES: without it, render_init makes every screen ARGB8888.
+//
+// render_clear, render_rect, render_text, render_blit(_keyed) and render_frame (a 1-pixel rectangle
+// outline: a square's bevel, as four gl_draw_lines unless BEVEL_SPANS) draw straight into the draw buffer
+// with the pixel kernels (pixel_kernels.h), clipped to the screen; blits take w x h pixels in the screen's format, rows packed. Text is copied
+// glyph by glyph from an atlas of the font pre-expanded in the text's colors (kept until the colors
+// change): render_text draws just the characters' pixels, render_text_blit whole cells, fg on bg.
+//
+// The render_list_* calls record commands instead of drawing; render_list_flush runs them all (call it
+// just before gl_swap_buffer). Before running them it drops every command a later solid one (rect, blit)
+// covers completely, merges same-color rects that touch into one, and puts the commands in scanline
+// order -- without ever reordering two commands that overlap, so the frame comes out the same as if
+// each had been drawn right away. The counters show how much work that saved.
+
+typedef enum { RENDER_ARGB8888 = 0, RENDER_RGB565 } render_format_t;
+
+#ifndef RGB565_FRAMES // (make RGB565_FRAMES=1)
+#define RGB565_FRAMES 0 // if this == 1, RENDER_RGB565 screens are drawn 16 bits per pixel (and integration_test_v10 draws the game that way); 0 leaves the 16-bit frame out
+#endif
+
+#ifndef BEVEL_SPANS // (make BEVEL_SPANS=1)
+#define BEVEL_SPANS 0 // if this == 1, render_frame writes its outline as spans; 0 draws it with gl_draw_line (libmango's is anti-aliased, and the spans haven't been checked against it on the board: test_bevel_frames)
+#endif
+
+#define RENDER_RGB565_MAX_PIXELS (320 * 640)    // biggest RGB565 screen (a 16 x 32 board of 20-pixel squares)
+
+#define RENDER_LIST_CAPACITY 512    // commands per flush (a full list flushes early)
+#define RENDER_LIST_TEXT 512        // characters of text per flush
+
+typedef struct {
+    unsigned long recorded;     // commands recorded
+    unsigned long issued;       // commands drawn
+    unsigned long culled;       // dropped as fully covered by a later solid command
+    unsigned long merged;       // rects merged into a neighbor
+    unsigned long flushes;
+} render_stats_t;
+
+void render_init(int width, int height, render_format_t format);  // (too big for RGB565: ARGB8888)
+render_format_t render_get_format(void);
+void* render_get_draw_buffer(void);     // width x height pixels in the screen's format, NULL if none
+void render_show(void);                 // instead of gl_swap_buffer
+
+void render_clear(color_t color);
+void render_rect(int x, int y, int w, int h, color_t color);
+void render_text(int x, int y, const char* str, color_t color);
+void render_text_blit(int x, int y, const char* str, color_t fg, color_t bg);
+void render_blit(int x, int y, int w, int h, const void* pixels);
+void render_blit_keyed(int x, int y, int w, int h, const void* pixels, color_t key);   // key pixels are skipped
+void render_frame(int x, int y, int w, int h, color_t color);
+
+void render_list_rect(int x, int y, int w, int h, color_t color);
+void render_list_frame(int x, int y, int w, int h, color_t color);
+void render_list_text(int x, int y, const char* str, color_t color);   // str is copied
+void render_list_blit(int x, int y, int w, int h, const void* pixels);  // pixels (w x h) must stay put until the flush
+
+void render_list_flush(void);
+
+render_stats_t render_list_get_stats(void);
+
+#endif
@@ -0,0 +1,48 @@
+/* replay.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The replay.c module re-runs a game recorded by input_log.c against the game engine, either in
+* real time (to watch it) or as fast as possible with rendering off (to benchmark it).
+* The same replay runs on the Mango Pi (testing.c) and on a computer (host/replay_main.c).
+*/
+
+#include "replay.h"
+#include "game_update.h"
+#include "timer.h"
+
+bool replay_run(game_t *game, const input_log_t *log, replay_mode_t mode, replay_result_t *result) {
+    *result = (replay_result_t){0};
+    struct input_recorder *recorder = game->recorder;
+    bool headless = game->headless;
+    game_update_set_recorder(game, NULL);  // the log being replayed may be this game's own recording
+    game_update_set_headless(game, mode == REPLAY_FAST);
+    game_update_init_seeded(game, log->nrows, log->ncols, log->seed);
+
+    unsigned long start = timer_get_ticks();
+    unsigned long due = start;
+    falling_piece_t piece = init_falling_piece(game);
+    size_t pos = 0;
+    game_cmd_t cmd;
+    unsigned long delta_ms;
+    while (input_log_next(log, &pos, &cmd, &delta_ms)) {  // the game may take a few commands to notice it's over
+        if (mode == REPLAY_REALTIME) {
+            due += delta_ms * 1000 * TICKS_PER_USEC;
+            while (timer_get_ticks() < due) ;
+        }
+        if (!game_update_run_command(game, cmd, &piece)) {
+            result->diverged = true;
+            break;
+        }
+        if (cmd == GAME_CMD_LOCK) result->pieces++;
+        result->commands++;
+    }
+    result->ticks = timer_get_ticks() - start;
+    result->score = game_update_get_score(game);
+    result->lines = game_update_get_rows_cleared(game);
+    result->game_over = game_update_is_game_over(game);
+
+    game_update_set_headless(game, headless);
+    game_update_set_recorder(game, recorder);
+    return !result->diverged && pos == log->len;
+}
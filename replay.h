@@ -0,0 +1,26 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdbool.h>
+#include "input_log.h"
+
+typedef enum {
+    REPLAY_REALTIME,    // commands run at their recorded times, game is drawn as usual
+    REPLAY_FAST,        // commands run back to back, headless (no drawing, delays or sound)
+} replay_mode_t;
+
+typedef struct {
+    int score;
+    int lines;
+    int pieces;                 // pieces locked
+    unsigned long commands;     // commands replayed
+    unsigned long ticks;        // timer ticks the replay took
+    bool game_over;
+    bool diverged;              // a recorded lock didn't happen (log doesn't match this build of the game)
+} replay_result_t;
+
+// Plays the logged game again from its seed on game (which is re-initialized; its recorder is
+// left alone). Returns false if the log couldn't be replayed all the way (see result->diverged)
+bool replay_run(game_t *game, const input_log_t *log, replay_mode_t mode, replay_result_t *result);
+
+#endif
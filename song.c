@@ -0,0 +1,96 @@
+/* song.c
+ * Module to read songs stored in the compact binary song format (format described in song.h)
+ * Author: Aditi (aditijb@stanford.edu)
+ */
+
+#include "song.h"
+#include "uart.h"
+
+#define uSEC_IN_SEC 1000000
+#define MIDI_C8 108 // highest note in octave_8_freq
+
+// note frequencies (Hz) of the 8th octave, C8 through B8. lower octaves are found by halving,
+// which keeps ~1Hz accuracy all the way down (same values as music.h's NOTE_FREQ_* enum)
+static const int octave_8_freq[12] = { 4186, 4435, 4699, 4978, 5274, 5588, 5920, 6272, 6645, 7040, 7459, 7902 } ;
+
+// `read_u16`
+// reads a little-endian 16-bit field from the header
+static int read_u16(const unsigned char *p) {
+    return p[0] | (p[1] << 8) ;
+}
+
+// `midi_to_freq`
+// @param midi note number (1 to 108)
+// @returns frequency in Hz, rounded to nearest
+static int midi_to_freq(int midi) {
+    int shift = (MIDI_C8 + 11 - midi) / 12 ; // number of octaves below the 8th
+    int freq = octave_8_freq[(midi - MIDI_C8 + 12 * shift) % 12] ;
+    if (shift == 0) return freq ;
+    return (freq + (1 << (shift - 1))) >> shift ;
+}
+
+// 'song_parse'
+// checks the header and points the song at its packed events
+bool song_parse(song_t *song, const unsigned char *data, size_t len) {
+    if (len < SONG_HEADER_SIZE) return false ;
+    if (data[0] != 'T' || data[1] != 'S' || data[2] != 'N' || data[3] != 'G') return false ;
+    if (data[4] != SONG_VERSION) return false ;
+
+    int nevents = read_u16(data + 8) ;
+    if (len < SONG_HEADER_SIZE + (size_t)nevents * SONG_EVENT_SIZE) return false ;
+
+    song->events = data + SONG_HEADER_SIZE ;
+    song->nevents = nevents ;
+    song->tempo = read_u16(data + 6) ;
+    song->loop = (data[5] & SONG_FLAG_LOOP) != 0 ;
+    song->loop_start = read_u16(data + 10) ;
+    song->loop_end = read_u16(data + 12) ;
+
+    // loop section must be non-empty and inside the song
+    if (song->loop && (song->loop_start >= song->loop_end || song->loop_end > nevents)) return false ;
+    return true ;
+}
+
+// 'song_decode'
+// unpacks a single note event
+void song_decode(const song_t *song, int index, song_event_t *event) {
+    const unsigned char *packed = song->events + index * SONG_EVENT_SIZE ;
+    int midi = packed[0] ;
+
+    // remember: we need to use note freq / 2 for the toggle in passive_buzz_intr to work
+    if (midi == 0 || midi > MIDI_C8 + 11) event->half_period_us = 0 ; // rest
+    else event->half_period_us = (uSEC_IN_SEC / midi_to_freq(midi)) / 2 ;
+    event->eighths = packed[1] ;
+}
+
+// 'song_next_index'
+// steps through the song, wrapping around the loop section
+int song_next_index(const song_t *song, int index) {
+    index++ ;
+    if (song->loop && index == song->loop_end) return song->loop_start ;
+    if (index >= song->nevents) return -1 ;
+    return index ;
+}
+
+// 'song_receive_uart'
+// reads a song file from the host into buf. the host sends the raw song file (header + events)
+bool song_receive_uart(song_t *song, unsigned char *buf, size_t bufsize) {
+    if (bufsize < SONG_HEADER_SIZE) return false ;
+
+    // sync on the magic so stray characters sent before the song are ignored
+    const char *magic = "TSNG" ;
+    int matched = 0 ;
+    while (matched < 4) {
+        char ch = uart_getchar() ;
+        if (ch == magic[matched]) matched++ ;
+        else matched = (ch == magic[0]) ? 1 : 0 ;
+    }
+    for (int i = 0; i < 4; i++) buf[i] = magic[i] ;
+
+    for (int i = 4; i < SONG_HEADER_SIZE; i++) buf[i] = uart_getchar() ;
+    size_t len = SONG_HEADER_SIZE + (size_t)read_u16(buf + 8) * SONG_EVENT_SIZE ;
+    if (len > bufsize) return false ;
+    for (size_t i = SONG_HEADER_SIZE; i < len; i++) buf[i] = uart_getchar() ;
+
+    return song_parse(song, buf, len) ;
+}
@@ -0,0 +1,86 @@
+/* song.h
+ * Module to read songs stored in the compact binary song format (see below)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * Binary song format (all multi-byte fields are little-endian):
+ *
+ *      offset  size    field
+ *      0       4       magic "TSNG"
+ *      4       1       format version (SONG_VERSION)
+ *      5       1       flags (SONG_FLAG_LOOP: jump back to loop_start after loop_end)
+ *      6       2       tempo in beats per minute (see music.h for reasonable tempos)
+ *      8       2       number of note events
+ *      10      2       loop_start - index of the first event of the looped section
+ *      12      2       loop_end - index one past the last event of the looped section
+ *      14      2*n     note events. each event is 2 bytes:
+ *                          byte 0 - pitch as a MIDI note number (60 = middle C, 0 = rest)
+ *                          byte 1 - length in eighth notes (1 = eighth, 2 = quarter, 8 = whole)
+ *
+ * Songs are written as text scores and converted with tools/song2bin.py (run `make songs`
+ * to regenerate the linked-in song_assets.c/.h), or sent over uart by the host.
+ * A song_t only points at the packed events; notes are decoded one at a time while playing.
+ */
+
+#ifndef SONG_H
+#define SONG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SONG_VERSION 1
+#define SONG_HEADER_SIZE 14
+#define SONG_EVENT_SIZE 2
+#define SONG_FLAG_LOOP 0x1
+
+typedef struct {
+    const unsigned char *events ; // packed 2-byte note events (not copied!)
+    int nevents ;
+    int tempo ;                   // in beats per minute
+    int loop_start ;
+    int loop_end ;
+    bool loop ;
+} song_t ;
+
+/* song_event_t
+ * a single decoded note, ready for passive_buzz_intr's timers
+ */
+typedef struct {
+    int half_period_us ; // time between buzzer toggles; 0 for a rest
+    int eighths ;        // note length in eighth notes
+} song_event_t ;
+
+/* 'song_parse'
+ * @param song_t *song - song to fill in
+ * @param const unsigned char *data, size_t len - a full song file (header + events)
+ * @return - true if data holds a valid song
+ * @functionality - checks the header of a packed song and points song at its events. data must
+ *                  stay around for as long as the song is played (events are decoded lazily)
+ */
+bool song_parse(song_t *song, const unsigned char *data, size_t len) ;
+
+/* 'song_decode'
+ * @param const song_t *song - song to decode from
+ * @param int index - event index (0 to nevents-1)
+ * @param song_event_t *event - receives the decoded note
+ * @functionality - unpacks a single note event (pitch -> buzzer half period)
+ */
+void song_decode(const song_t *song, int index, song_event_t *event) ;
+
+/* 'song_next_index'
+ * @param const song_t *song - song being played
+ * @param int index - index of the event that was just decoded
+ * @return - index of the event that follows it, or -1 if the song is over
+ * @functionality - steps through the song, wrapping from loop_end back to loop_start for looped songs
+ */
+int song_next_index(const song_t *song, int index) ;
+
+/* 'song_receive_uart'
+ * @param song_t *song - song to fill in
+ * @param unsigned char *buf, size_t bufsize - caller-owned storage for the packed song
+ * @return - true if a valid song that fits in buf was received
+ * @functionality - blocks until the host sends a song file over uart (e.g. the output of
+ *                  tools/song2bin.py), storing it packed in buf. Only the packed bytes are kept in RAM
+ */
+bool song_receive_uart(song_t *song, unsigned char *buf, size_t bufsize) ;
+
+#endif
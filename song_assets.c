@@ -0,0 +1,32 @@
+/* song_assets.c
+ * Generated by tools/song2bin.py from the scores in songs/ -- do not edit, run `make songs`
+ */
+
+#include "song_assets.h"
+
+const unsigned char song_interlude[] = {
+    0x54, 0x53, 0x4e, 0x47, 0x01, 0x01, 0x55, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00,
+    0x40, 0x04, 0x3c, 0x04, 0x3e, 0x04, 0x3b, 0x04, 0x3c, 0x04, 0x39, 0x04, 0x38, 0x08,
+    0x40, 0x04, 0x3c, 0x04, 0x3e, 0x04, 0x3b, 0x04, 0x3c, 0x02, 0x40, 0x02, 0x45, 0x04,
+    0x44, 0x08, 0x00, 0x04,
+} ;
+const unsigned int song_interlude_size = sizeof(song_interlude) ;
+
+const unsigned char song_tetris[] = {
+    0x54, 0x53, 0x4e, 0x47, 0x01, 0x01, 0x8c, 0x00, 0x5d, 0x00, 0x00, 0x00, 0x5d, 0x00,
+    0x40, 0x02, 0x3b, 0x01, 0x3c, 0x01, 0x3e, 0x02, 0x3c, 0x01, 0x3b, 0x01, 0x39, 0x02,
+    0x39, 0x01, 0x3c, 0x01, 0x40, 0x02, 0x3e, 0x01, 0x3c, 0x01, 0x3b, 0x02, 0x3b, 0x01,
+    0x3c, 0x01, 0x3e, 0x02, 0x40, 0x02, 0x3c, 0x02, 0x39, 0x02, 0x39, 0x04, 0x3e, 0x01,
+    0x3e, 0x02, 0x41, 0x01, 0x45, 0x02, 0x43, 0x01, 0x41, 0x01, 0x40, 0x03, 0x3c, 0x01,
+    0x40, 0x02, 0x3e, 0x01, 0x3c, 0x01, 0x3b, 0x02, 0x3b, 0x01, 0x3c, 0x01, 0x3e, 0x02,
+    0x40, 0x02, 0x3c, 0x02, 0x39, 0x02, 0x39, 0x04, 0x40, 0x02, 0x3b, 0x01, 0x3c, 0x01,
+    0x3e, 0x02, 0x3c, 0x01, 0x3b, 0x01, 0x39, 0x02, 0x39, 0x01, 0x3c, 0x01, 0x40, 0x02,
+    0x3e, 0x01, 0x3c, 0x01, 0x3b, 0x02, 0x3b, 0x01, 0x3c, 0x01, 0x3e, 0x02, 0x40, 0x02,
+    0x3c, 0x02, 0x39, 0x02, 0x39, 0x04, 0x3e, 0x01, 0x3e, 0x02, 0x41, 0x01, 0x45, 0x02,
+    0x43, 0x01, 0x41, 0x01, 0x40, 0x03, 0x3c, 0x01, 0x40, 0x02, 0x3e, 0x01, 0x3c, 0x01,
+    0x3b, 0x02, 0x3b, 0x01, 0x3c, 0x01, 0x3e, 0x02, 0x40, 0x02, 0x3c, 0x02, 0x39, 0x02,
+    0x39, 0x04, 0x40, 0x04, 0x3c, 0x04, 0x3e, 0x04, 0x3b, 0x04, 0x3c, 0x04, 0x39, 0x04,
+    0x38, 0x08, 0x40, 0x04, 0x3c, 0x04, 0x3e, 0x04, 0x3b, 0x04, 0x3c, 0x02, 0x40, 0x02,
+    0x45, 0x04, 0x44, 0x08,
+} ;
+const unsigned int song_tetris_size = sizeof(song_tetris) ;
@@ -0,0 +1,13 @@
+/* song_assets.h
+ * Generated by tools/song2bin.py from the scores in songs/ -- do not edit, run `make songs`
+ */
+
+#ifndef SONG_ASSETS_H
+#define SONG_ASSETS_H
+
+extern const unsigned char song_interlude[] ;
+extern const unsigned int song_interlude_size ;
+extern const unsigned char song_tetris[] ;
+extern const unsigned int song_tetris_size ;
+
+#endif
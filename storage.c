@@ -0,0 +1,33 @@
+/* storage.c
+ * Module for block storage, Mango Pi version: the blocks are kept in RAM
+ * Author: Aditi (aditijb@stanford.edu)
+ * There is no SD card driver in the cs107e libraries, so this stands in for one: everything written
+ * lasts until the board is reset (new games, the leaderboard, the interlude all see it)
+ */
+
+#include "storage.h"
+#include "strings.h"
+
+#define STORAGE_NBLOCKS 1024 // 512KB: each half of the leaderboard log holds a full board (leaderboard.h) and then some
+
+static unsigned char blocks[STORAGE_NBLOCKS][STORAGE_BLOCK_SIZE] ; // zeroed at boot
+
+bool storage_init(void) {
+    return true ;
+}
+
+unsigned long storage_get_nblocks(void) {
+    return STORAGE_NBLOCKS ;
+}
+
+bool storage_read(unsigned long block, void *buf) {
+    if (block >= STORAGE_NBLOCKS) return false ;
+    memcpy(buf, blocks[block], STORAGE_BLOCK_SIZE) ;
+    return true ;
+}
+
+bool storage_write(unsigned long block, const void *buf) {
+    if (block >= STORAGE_NBLOCKS) return false ;
+    memcpy(blocks[block], buf, STORAGE_BLOCK_SIZE) ;
+    return true ;
+}
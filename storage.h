@@ -0,0 +1,38 @@
+/* storage.h
+ * Module for block storage: numbered fixed-size blocks that keep their contents (the leaderboard log,
+ * leaderboard_log.h, is stored on it)
+ * Author: Aditi (aditijb@stanford.edu)
+ *
+ * This is the one place that knows where the blocks really are. On the host (make host) they are a
+ * plain file (host/hal_storage.c). The cs107e libraries have no SD card driver, so on the Mango Pi
+ * storage.c keeps them in RAM for now: they last until the board is reset. An SD card driver would
+ * replace storage.c behind the same four calls.
+ * Blocks read before they were ever written read as all zeros.
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdbool.h>
+
+#define STORAGE_BLOCK_SIZE 512 // bytes per block (an SD card sector)
+
+/* 'storage_init'
+ * @return - true if the storage is ready to use. safe to call again
+ */
+bool storage_init(void) ;
+
+/* 'storage_get_nblocks'
+ * @return - number of blocks (numbered 0 .. nblocks - 1)
+ */
+unsigned long storage_get_nblocks(void) ;
+
+/* 'storage_read' / 'storage_write'
+ * @param unsigned long block - block number
+ * @param buf - STORAGE_BLOCK_SIZE bytes to read into / write from
+ * @return - true on success (false for a block number out of range or a device error)
+ */
+bool storage_read(unsigned long block, void *buf) ;
+bool storage_write(unsigned long block, const void *buf) ;
+
+#endif
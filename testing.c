@@ -17,6 +17,26 @@
 #include "game_interlude.h"
 #include "console.h"
 #include "music.h"
+#include "song.h"
+#include "isr_stats.h"
+#include "profiler.h"
+#include "random_bag.h"
+#include "input_log.h"
+#include "replay.h"
+#include "autoplay.h"
+#include "hint.h"
+#include "pixel_kernels.h"
+#include "render.h"
+#include "leaderboard.h"
+#include "leaderboard_log.h"
+
+#define PROFILE_GAME 0 // if this == 1, integration_test_v10 profiles each game and dumps the profile over uart (see profiler.h)
+#define REPLAY_GAME 0 // if this == 1, integration_test_v10 dumps each game's input log over uart and replays it (see replay.h)
+#define SHOW_HINTS 0 // if this == 1, integration_test_v10 outlines the best landing spot for the falling piece (see hint.h)
+#define GAME_PIXEL_FORMAT (RGB565_FRAMES ? RENDER_RGB565 : RENDER_ARGB8888) // make RGB565_FRAMES=1 has integration_test_v10 draw the game 16 bits per pixel (see render.h)
+
+static game_t game; // the game the tests play
+static input_recorder_t recorder; // input log of the last game played in integration_test_v10
 
 // void pause(const char *message) {
 //     if (message) printf("\n%s\n", message);
@@ -38,39 +58,47 @@ int get_keystroke(const char *message) {
 void test_random_init(void) {
     for (int i = 0; i < 10; i++) {
         timer_init();
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        init_falling_piece(&game);
         pause("start");
     }
 }
 
+void test_random_seed(void) { // same seed -> same pieces, here and on the computer
+    uart_init();
+    random_bag_t bag;
+    random_bag_set_seed(&bag, 42);
+    for (int i = 0; i < 21; i++) printf("%d", random_bag_choose(&bag));
+    printf("\nexpected 526140356234010546231 (seed 42)\n");
+}
+
 void test_basic_block_motion(void) {
     timer_init();
-    game_update_init(20, 10);
-    falling_piece_t piece = init_falling_piece();
+    game_update_init(&game, 20, 10);
+    falling_piece_t piece = init_falling_piece(&game);
     while (1) {
         pause("key press to move down");
-        move_down(&piece);
+        move_down(&game, &piece);
         if (piece.fallen) {
             printf("fallen; new piece spawning");
-            piece = init_falling_piece();
+            piece = init_falling_piece(&game);
         }
     }
 }
 
 void test_motions(void) {
     timer_init();
-    game_update_init(20, 10);
-    falling_piece_t piece = init_falling_piece();
+    game_update_init(&game, 20, 10);
+    falling_piece_t piece = init_falling_piece(&game);
     while (1) {
         int ch = get_keystroke("key press to move down (S) / left (A) / right (D) or rotate (R)");
-        if (ch == 's') move_down(&piece);
-        else if (ch == 'a') move_left(&piece);
-        else if (ch == 'd') move_right(&piece);
-        else if (ch == 'r') rotate(&piece);
+        if (ch == 's') move_down(&game, &piece);
+        else if (ch == 'a') move_left(&game, &piece);
+        else if (ch == 'd') move_right(&game, &piece);
+        else if (ch == 'r') rotate(&game, &piece);
         if (piece.fallen) {
             printf("fallen; new piece spawning");
-            piece = init_falling_piece();
+            piece = init_falling_piece(&game);
         }
     }
 }
@@ -103,9 +131,9 @@ void test_motions_integrated(void) { // OBSOLETE TEST FUNCTION!!
     remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6,TEMPO_DEFAULT) ; 
     interrupts_global_enable() ;
     
-    game_update_init(20, 10);
+    game_update_init(&game, 20, 10);
 
-    falling_piece_t piece = init_falling_piece();
+    falling_piece_t piece = init_falling_piece(&game);
 
     printf("\nin test_motions_integrated; initialized\n") ;
 
@@ -120,29 +148,29 @@ void test_motions_integrated(void) { // OBSOLETE TEST FUNCTION!!
         remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
         
         // horizontal movement
-        if (roll == LEFT) move_left(&piece);
-        else if (roll == RIGHT) move_right(&piece);
+        if (roll == LEFT) move_left(&game, &piece);
+        else if (roll == RIGHT) move_right(&game, &piece);
         
         // drop a block faster
         if (pitch == X_FAST) { 
             // printf("\n*** x dropped ***\n"); // for debugging
             if(!piece.fallen){
-                move_down(&piece);
+                move_down(&game, &piece);
             }
             if(!piece.fallen){
-                move_down(&piece);
+                move_down(&game, &piece);
             }
         }
 
         while (remote_is_button_press()) {
-            rotate(&piece);
+            rotate(&game, &piece);
         }
         
-        move_down(&piece);
+        move_down(&game, &piece);
 
         if (piece.fallen) {
             // printf("fallen; new piece spawning"); // for debugging
-            piece = init_falling_piece();
+            piece = init_falling_piece(&game);
         }
 
         while (timer_get_ticks() % n != 0) {
@@ -159,8 +187,8 @@ void integration_test_v2(void) {
     remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6,TEMPO_DEFAULT) ; 
     interrupts_global_enable() ;
     
-    game_update_init(20, 10);
-    falling_piece_t piece = init_falling_piece();
+    game_update_init(&game, 20, 10);
+    falling_piece_t piece = init_falling_piece(&game);
 
     printf("\nin test_motions_integrated; initialized\n") ;
 
@@ -180,33 +208,33 @@ void integration_test_v2(void) {
     
             // horizontal movement
             if (toggle_turns % 3 == 0) {
-                if (roll == LEFT) move_left(&piece);
-                else if (roll == RIGHT) move_right(&piece);                
+                if (roll == LEFT) move_left(&game, &piece);
+                else if (roll == RIGHT) move_right(&game, &piece);                
             }
         
             // drop a block faster
             if (pitch == X_FAST) { 
                 printf("\n*** x dropped fast ***\n"); // for debugging
                 if (!piece.fallen){
-                    move_down(&piece);
+                    move_down(&game, &piece);
                 }
                 if (!piece.fallen){
-                    move_down(&piece);
+                    move_down(&game, &piece);
                 }
             }
 
             while (remote_is_button_press()) {
-                rotate(&piece);
+                rotate(&game, &piece);
             }  
             if (piece.fallen) {
-                piece = init_falling_piece();
+                piece = init_falling_piece(&game);
             }
             // timer_delay_ms(20);
         } 
         printf("timer get ticks END(): %ld\n", timer_get_ticks() % n) ;     
         
         printf("\n*** x dropped normal ***\n"); // for debugging
-        move_down(&piece);
+        move_down(&game, &piece);
 
         while (timer_get_ticks() % n > (0.8 * n)) {
             printf("waiting...");
@@ -340,8 +368,8 @@ void integration_test_v3(void) {
     game_interlude_init(30, 50, GL_AMBER, GL_BLACK) ; // can do this outside
 
     while(1) {
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
 
         // write accelerometer x/y position to pitch(x) and roll(y)
         int pitch = 0; int roll = 0;
@@ -358,29 +386,29 @@ void integration_test_v3(void) {
         
                 // horizontal movement
                 if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece);                
+                    if (roll == LEFT) move_left(&game, &piece);
+                    else if (roll == RIGHT) move_right(&game, &piece);                
                 }
             
                 // drop a block faster
                 if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+                    if (!piece.fallen) move_down(&game, &piece);
+                    if (!piece.fallen) move_down(&game, &piece);
                 }
 
-                while (remote_is_button_press()) rotate(&piece);
-                if (piece.fallen) piece = init_falling_piece();
+                while (remote_is_button_press()) rotate(&game, &piece);
+                if (piece.fallen) piece = init_falling_piece(&game);
             } 
 
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
+            move_down(&game, &piece);
+            if (game_update_is_game_over(&game)) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
 
             while (timer_get_ticks() % n > (0.8 * n)) {
                 // RESOLVED WITH passive_buzz_intr.c aditi play music notes in here???
             };
         } 
 
-        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()) ; 
+        game_interlude_print_leaderboard(game_update_get_score(&game), game_update_get_rows_cleared(&game)) ; 
     }
 }
 
@@ -405,8 +433,8 @@ void integration_test_v4(void) {
     game_interlude_init(30, 50, GL_AMBER, GL_BLACK) ; // can do this outside
 
     while(1) {
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
 
         // write accelerometer x/y position to pitch(x) and roll(y)
         int pitch = 0; int roll = 0;
@@ -427,22 +455,22 @@ void integration_test_v4(void) {
         
                 // horizontal movement
                 if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece);                
+                    if (roll == LEFT) move_left(&game, &piece);
+                    else if (roll == RIGHT) move_right(&game, &piece);                
                 }
             
                 // drop a block faster
                 if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+                    if (!piece.fallen) move_down(&game, &piece);
+                    if (!piece.fallen) move_down(&game, &piece);
                 }
 
-                while (remote_is_button_press()) rotate(&piece);
-                if (piece.fallen) piece = init_falling_piece();
+                while (remote_is_button_press()) rotate(&game, &piece);
+                if (piece.fallen) piece = init_falling_piece(&game);
             } 
 
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
+            move_down(&game, &piece);
+            if (game_update_is_game_over(&game)) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
 
             music_index += 1; music_index %= num_notes; 
             int note_period = (uSEC_IN_SEC / music_notes[music_index]) ; // keep it approximate
@@ -456,7 +484,7 @@ void integration_test_v4(void) {
             };
         } 
 
-        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()) ; 
+        game_interlude_print_leaderboard(game_update_get_score(&game), game_update_get_rows_cleared(&game)) ; 
     }
 }
 
@@ -477,8 +505,8 @@ void integration_test_v5(void) {
     // game_interlude_init(30, 50, GL_AMBER, GL_BLACK) ; // can do this outside
 
     // while(1) {
-    //     game_update_init(20, 10);
-    //     falling_piece_t piece = init_falling_piece();
+    //     game_update_init(&game, 20, 10);
+    //     falling_piece_t piece = init_falling_piece(&game);
 
     //     // write accelerometer x/y position to pitch(x) and roll(y)
     //     int pitch = 0; int roll = 0;
@@ -534,22 +562,22 @@ void integration_test_v5(void) {
         
     //             // horizontal movement
     //             if (toggle_turns % 3 == 0) {
-    //                 if (roll == LEFT) move_left(&piece);
-    //                 else if (roll == RIGHT) move_right(&piece);                
+    //                 if (roll == LEFT) move_left(&game, &piece);
+    //                 else if (roll == RIGHT) move_right(&game, &piece);                
     //             }
             
     //             // drop a block faster
     //             if (pitch == X_FAST) { 
-    //                 if (!piece.fallen) move_down(&piece);
-    //                 if (!piece.fallen) move_down(&piece);
+    //                 if (!piece.fallen) move_down(&game, &piece);
+    //                 if (!piece.fallen) move_down(&game, &piece);
     //             }
 
-    //             while (remote_is_button_press()) rotate(&piece);
-    //             if (piece.fallen) piece = init_falling_piece();
+    //             while (remote_is_button_press()) rotate(&game, &piece);
+    //             if (piece.fallen) piece = init_falling_piece(&game);
     //         } 
 
-    //         move_down(&piece);
-    //         if (game_update_is_game_over()) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
+    //         move_down(&game, &piece);
+    //         if (game_update_is_game_over(&game)) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
 
     //         music_index += 1; music_index %= num_notes; 
     //         int note_period = (uSEC_IN_SEC / music_notes[music_index]) ; // keep it approximate
@@ -557,7 +585,7 @@ void integration_test_v5(void) {
     //         while (timer_get_ticks() % n > (0.8 * n)) {};
     //     } 
 
-    //     game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()) ; 
+    //     game_interlude_print_leaderboard(game_update_get_score(&game), game_update_get_rows_cleared(&game)) ; 
     // }
 }
 
@@ -577,8 +605,8 @@ void integration_test_v6(void) {
     game_interlude_init(30, 50, GL_WHITE, GL_INDIGO) ; // can do this outside
 
     while(1) {
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
 
         // write accelerometer x/y position to pitch(x) and roll(y)
         int pitch = 0; int roll = 0;
@@ -595,47 +623,47 @@ void integration_test_v6(void) {
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                 if (toggle_turns % 9 == 0) {
-                    if (pitch == X_SWAP) swap(&piece);
+                    if (pitch == X_SWAP) swap(&game, &piece);
                 }
 
                 if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece); 
+                    if (roll == LEFT) move_left(&game, &piece);
+                    else if (roll == RIGHT) move_right(&game, &piece); 
                 }
 
                 // drop a block faster
                 if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+                    if (!piece.fallen) move_down(&game, &piece);
+                    if (!piece.fallen) move_down(&game, &piece);
                 }
 
-                while (remote_is_button_press()) rotate(&piece);
+                while (remote_is_button_press()) rotate(&game, &piece);
                 if (piece.fallen) {
                     remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                     // horizontal movement
                     if (roll == LEFT) {
-                        move_left(&piece);
+                        move_left(&game, &piece);
                     }
                     else if (roll == RIGHT) {
-                        move_right(&piece); 
+                        move_right(&game, &piece); 
                     }
 
-                    if (iterateVariant(&piece, checkIfFallen)) {
-                        iterateThroughPieceSquares(&piece, update_background);
-                        clearRows();
-                        piece = init_falling_piece();
+                    if (iterateVariant(&game, &piece, checkIfFallen)) {
+                        iterateThroughPieceSquares(&game, &piece, update_background);
+                        clearRows(&game);
+                        piece = init_falling_piece(&game);
                     }
                 }
             } 
             
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
+            move_down(&game, &piece);
+            if (game_update_is_game_over(&game)) {timer_delay(2); break;} // exits game-playing mode if game is over
 
             while (timer_get_ticks() % n > (0.8 * n)) {};
         } 
 
-        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
+        game_interlude_print_leaderboard(game_update_get_score(&game), game_update_get_rows_cleared(&game)); 
     }
 }
 
@@ -683,8 +711,8 @@ void integration_test_v9(void) {
     game_interlude_init(30, 50, GL_WHITE, GL_INDIGO) ; // can do this outside
 
     while(1) {
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
 
         // write accelerometer x/y position to pitch(x) and roll(y)
         int pitch = 0; int roll = 0;
@@ -701,48 +729,48 @@ void integration_test_v9(void) {
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                 if (toggle_turns % 9 == 0) {
-                    if (pitch == X_SWAP) swap(&piece);
+                    if (pitch == X_SWAP) swap(&game, &piece);
                 }
 
                 // horizontal movement or swap
                 if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece); 
+                    if (roll == LEFT) move_left(&game, &piece);
+                    else if (roll == RIGHT) move_right(&game, &piece); 
                 }
 
                 // drop a block faster
                 if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+                    if (!piece.fallen) move_down(&game, &piece);
+                    if (!piece.fallen) move_down(&game, &piece);
                 }
 
-                while (remote_is_button_press()) rotate(&piece);
+                while (remote_is_button_press()) rotate(&game, &piece);
                 if (piece.fallen) {
                     remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                     // horizontal movement
                     if (roll == LEFT) {
-                        move_left(&piece);
+                        move_left(&game, &piece);
                     }
                     else if (roll == RIGHT) {
-                        move_right(&piece); 
+                        move_right(&game, &piece); 
                     }
 
-                    if (iterateVariant(&piece, checkIfFallen)) {
-                        iterateThroughPieceSquares(&piece, update_background);
-                        clearRows(); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
-                        piece = init_falling_piece();
+                    if (iterateVariant(&game, &piece, checkIfFallen)) {
+                        iterateThroughPieceSquares(&game, &piece, update_background);
+                        clearRows(&game); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
+                        piece = init_falling_piece(&game);
                     }
                 }
             } 
             
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
+            move_down(&game, &piece);
+            if (game_update_is_game_over(&game)) {timer_delay(2); break;} // exits game-playing mode if game is over
 
             while (timer_get_ticks() % n > (0.8 * n)) {};
         } 
 
-        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
+        game_interlude_print_leaderboard(game_update_get_score(&game), game_update_get_rows_cleared(&game)); 
     }
 }
 
@@ -754,16 +782,21 @@ void integration_test_v10(void) {
     uart_init() ;
     interrupts_init() ; // interrupt sandwich start
     remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6, TEMPO_ALLEGRO) ;  // buzzer interrupt moved into remote_init
+    if (PROFILE_GAME == 1) profiler_init(997) ;
     interrupts_global_enable() ; // interrupt sandwich end
     timer_delay(2) ;
 
     remote_is_button_press() ; // get rid of the extra button press... 
 
     game_interlude_init(30, 50, GL_WHITE, GL_INDIGO) ; // can do this outside
+    game_update_set_recorder(&game, &recorder) ;
+    game_update_set_pixel_format(&game, GAME_PIXEL_FORMAT) ;
+    static hint_t hint ;
 
     while(1) {
-        game_update_init(20, 10);
-        falling_piece_t piece = init_falling_piece();
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
+        hint_init(&hint) ;
         buzzer_intr_set_tempo(TEMPO_ALLEGRO) ;
 
         // write accelerometer x/y position to pitch(x) and roll(y)
@@ -774,7 +807,8 @@ void integration_test_v10(void) {
 
         int toggle_turns = 0 ;
         
-        startGame();
+        startGame(&game);
+        if (PROFILE_GAME == 1) profiler_start() ;
 
         while(1) {
             while (timer_get_ticks() % n <= (0.8 * n)) {
@@ -784,53 +818,304 @@ void integration_test_v10(void) {
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                 if (toggle_turns % 7 == 0) {
-                    if (pitch == X_SWAP) swap(&piece);
+                    if (pitch == X_SWAP) swap(&game, &piece);
                 }
 
                 // horizontal movement or swap
                 if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece); 
+                    if (roll == LEFT) move_left(&game, &piece);
+                    else if (roll == RIGHT) move_right(&game, &piece); 
                 }
 
-                while (remote_is_button_press()) rotate(&piece);
+                if (SHOW_HINTS == 1) hint_update(&hint, &game, &piece, HINT_DEFAULT_BUDGET_CYCLES) ; // a slice of the search per pass
+                while (remote_is_button_press()) rotate(&game, &piece);
                 if (piece.fallen) {
                     remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
                     // horizontal movement
                     if (roll == LEFT) {
-                        move_left(&piece);
+                        move_left(&game, &piece);
                     }
                     else if (roll == RIGHT) {
-                        move_right(&piece); 
+                        move_right(&game, &piece); 
                     }
 
-                    if (iterateVariant(&piece, checkIfFallen)) {
-                        iterateThroughPieceSquares(&piece, update_background);
-                        clearRows(); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
-                        piece = init_falling_piece();
-                    }
+                    lock_piece(&game, &piece); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
                 }
 
                 // drop a block faster
                 if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+                    if (!piece.fallen) move_down(&game, &piece);
+                    if (!piece.fallen) move_down(&game, &piece);
                 }
             } 
             
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
+            move_down(&game, &piece);
+            if (game_update_is_game_over(&game)) {timer_delay(2); break;} // exits game-playing mode if game is over
 
             while (timer_get_ticks() % n > (0.8 * n)) {};
         } 
 
-        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
+        if (PROFILE_GAME == 1) {
+            profiler_stop() ;
+            profiler_dump() ;
+            profiler_reset() ;
+        }
+        isr_stats_report(); // how much the music/button interrupts cost during that game
+        isr_stats_reset();
+        int score = game_update_get_score(&game); int lines = game_update_get_rows_cleared(&game);
+        if (REPLAY_GAME == 1) test_replay_last_game(); // (replaying resets the game's score)
+        game_interlude_print_leaderboard(score, lines); 
     }
 }
 
+void test_replay_last_game(void) { // dumps the input log of the game just played, then replays it headless and checks it ends the same
+    int score = game_update_get_score(&game); int lines = game_update_get_rows_cleared(&game);
+    size_t len;
+    const unsigned char *buf = input_log_get(&recorder, &len);
+    input_log_t log;
+    if (!input_log_parse(&log, buf, len)) {
+        printf("no game recorded\n");
+        return;
+    }
+    input_log_dump(&recorder); // save this and run it on the computer: make host && ./host/replay dump.txt
+    if (input_log_is_truncated(&recorder)) printf("(input log filled up; replay stops early)\n");
+
+    replay_result_t result;
+    bool complete = replay_run(&game, &log, REPLAY_FAST, &result);
+    printf("replay seed %u: %d pieces, %ld commands in %ld us, score %d lines %d%s\n", (unsigned int)log.seed,
+           result.pieces, result.commands, result.ticks / TICKS_PER_USEC, result.score, result.lines,
+           complete ? "" : " (incomplete)");
+    if (!input_log_is_truncated(&recorder)) {
+        assert(result.score == score);
+        assert(result.lines == lines);
+    }
+}
+
+
 
 
 
 
 
+void test_song_uart(void) { // songs streamed from the host: tools/song2bin.py score.txt -o song.bin, then send song.bin
+    gpio_init() ;
+    timer_init() ;
+    uart_init() ;
+    interrupts_init() ;
+    buzzer_intr_init(GPIO_PB6, TEMPO_DEFAULT) ;
+    interrupts_global_enable() ;
+
+    static unsigned char song_buf[2048] ; // packed songs are 2 bytes per note
+    song_t song ;
+    while (1) {
+        printf("\nsend a song file over uart (playing the tetris theme until then)\n") ;
+        if (song_receive_uart(&song, song_buf, sizeof(song_buf))) {
+            printf("playing %d notes at tempo %d\n", song.nevents, song.tempo) ;
+            buzzer_intr_play_song(&song) ;
+            pause("any key to switch back to the tetris theme") ;
+            buzzer_intr_play_song(buzzer_intr_get_default_song()) ;
+        } else {
+            printf("not a valid song (or too big for the buffer)\n") ;
+        }
+    }
+}
+
+void test_sound_effects(void) { // effects over the song + how many cycles the buzzer handlers cost
+    gpio_init() ;
+    timer_init() ;
+    uart_init() ;
+    interrupts_init() ;
+    buzzer_intr_init(GPIO_PB6, TEMPO_ALLEGRO) ;
+    interrupts_global_enable() ;
+
+    while (1) {
+        int ch = get_keystroke("key press for effect: rotate (R) / line clear (L) / game over (G) / interrupt costs (C)") ;
+        if (ch == 'r') buzzer_intr_play_effect(SFX_ROTATE) ;
+        else if (ch == 'l') buzzer_intr_play_effect(SFX_LINE_CLEAR) ;
+        else if (ch == 'g') buzzer_intr_play_effect(SFX_GAME_OVER) ;
+        else if (ch == 'c') isr_stats_report() ;
+    }
+}
+
+void test_autoplay(void) { // the autoplayer plays (and draws) games forever; prints pieces/sec and placements/sec as it goes
+    gpio_init() ;
+    timer_init() ;
+    uart_init() ;
+    interrupts_init() ;
+    remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6, TEMPO_ALLEGRO) ;
+    interrupts_global_enable() ;
+
+    const int frame_us = 20000 ;   // one command per 20ms frame
+    const int budget_us = 2000 ;   // time the search may take out of each frame
+    static autoplay_search_t search ;
+
+    while (1) {
+        game_update_init(&game, 20, 10);
+        falling_piece_t piece = init_falling_piece(&game);
+        autoplay_search_begin(&search, &game, &piece, true) ;
+        bool searching = true ;
+        int pieces = 0 ; unsigned long evaluated = 0 ; unsigned long search_ticks = 0 ;
+        unsigned long start = timer_get_ticks() ;
+
+        while (!game_update_is_game_over(&game)) {
+            unsigned long frame_start = timer_get_ticks() ;
+            if (searching) {
+                searching = !autoplay_search_step(&search, budget_us) ;
+                search_ticks += timer_get_ticks() - frame_start ;
+                if (!searching) evaluated += search.ncandidates ;
+            } else {
+                game_cmd_t cmd = autoplay_next_command(&game, &search.best, &piece) ;
+                game_update_run_command(&game, cmd, &piece) ;
+                if (cmd == GAME_CMD_LOCK) {
+                    pieces++ ;
+                    autoplay_search_begin(&search, &game, &piece, true) ;
+                    searching = true ;
+                    if (pieces % 50 == 0) {
+                        unsigned long usecs = (timer_get_ticks() - start) / TICKS_PER_USEC ;
+                        printf("%d pieces, %d lines: %ld pieces/min, %ld candidates/s while searching\n", pieces,
+                               game_update_get_rows_cleared(&game), pieces * 60000000L / usecs,
+                               evaluated * 1000000L / (search_ticks / TICKS_PER_USEC + 1)) ;
+                    }
+                }
+            }
+            while (timer_get_ticks() - frame_start < frame_us * TICKS_PER_USEC) ;
+        }
+        printf("game over after %d pieces, score %d\n", pieces, game_update_get_score(&game)) ;
+    }
+}
+
+void test_pixel_kernels(void) { // checks the pixel kernels (rvv when built with the vector extension) against the scalar ones, then times both
+    uart_init() ;
+    static color_t a[200 * 400], b[200 * 400] ;   // (the game's screen size, for the timing)
+    int mismatches = pixel_kernels_check(a, b) ;
+    printf("pixel kernels (%s): %d mismatches\n", PIXEL_KERNELS_IMPL, mismatches) ;
+    assert(mismatches == 0) ;
+    pixel_kernels_bench(a, b, 200, 400, 20) ;
+}
+
+// leaderboard_log_open callback for test_leaderboard_log: counts the records and adds up their scores
+static void count_record(const leaderboard_record_t *record, void *arg) {
+    unsigned int *totals = arg ;
+    totals[0]++ ;
+    totals[1] += record->score ;
+}
+
+void test_leaderboard_log(void) { // fills the leaderboard log, compacts it, breaks a record (wipes the saved leaderboard!)
+    uart_init() ;
+    leaderboard_log_t log ;
+    unsigned int totals[2] = { 0, 0 } ;
+    assert(leaderboard_log_open(&log, count_record, totals)) ;
+    printf("leaderboard log: %d records found\n", totals[0]) ;
+    assert(totals[0] == leaderboard_log_get_count(&log)) ;
+
+    // empty it, then fill it up: every record is there when it's opened again
+    assert(leaderboard_log_compact(&log, NULL, 0)) ;
+    unsigned int n = 0 ; unsigned int sum = 0 ;
+    while (leaderboard_log_get_free(&log) > 0) {
+        leaderboard_record_t record = { { 'A' + n % 26, 'Z' - n % 26 }, n * 7, n % 100, n } ;
+        assert(leaderboard_log_append(&log, &record)) ;
+        sum += n * 7 ; n++ ;
+    }
+    leaderboard_record_t extra = { { 'X', 'X' }, 1, 1, 1 } ;
+    assert(!leaderboard_log_append(&log, &extra)) ; // (full)
+    totals[0] = totals[1] = 0 ;
+    assert(leaderboard_log_open(&log, count_record, totals)) ;
+    printf("filled: %d records (score total %d)\n", totals[0], totals[1]) ;
+    assert(totals[0] == n && totals[1] == sum) ;
+
+    // compact to 3, add one more
+    leaderboard_record_t keep[3] = { { { 'A', 'S' }, 300, 3, 10 }, { { 'A', 'J' }, 200, 2, 20 }, { { 'F', 'R' }, 100, 1, 30 } } ;
+    assert(leaderboard_log_compact(&log, keep, 3)) ;
+    assert(leaderboard_log_append(&log, &extra)) ;
+    totals[0] = totals[1] = 0 ;
+    assert(leaderboard_log_open(&log, count_record, totals)) ;
+    assert(totals[0] == 4 && totals[1] == 601) ;
+
+    // a broken record (bad checksum) ends the log there
+    unsigned char block[STORAGE_BLOCK_SIZE] ;
+    unsigned long first = log.half * log.half_blocks + 1 ; // the first record block
+    assert(storage_read(first, block)) ;
+    block[2 * 16 + 5] ^= 0x40 ; // record 2's score
+    assert(storage_write(first, block)) ;
+    totals[0] = totals[1] = 0 ;
+    assert(leaderboard_log_open(&log, count_record, totals)) ;
+    assert(totals[0] == 2 && totals[1] == 500) ;
+    printf("compacted, broken record skipped: ok\n") ;
+}
+
+void test_leaderboard_ranks(void) { // the all-time leaderboard past full: ranks, pages, best entries, and how long an add takes as it grows
+    uart_init() ;
+    static leaderboard_t board ;
+    leaderboard_init(&board) ;
+    unsigned int seed = 1 ;
+    unsigned long start = timer_get_ticks() ;
+    for (int i = 0; i < LEADERBOARD_MAX_ENTRIES + LEADERBOARD_MAX_ENTRIES / 2; i++) {
+        seed = seed * 1103515245 + 12345 ;
+        leaderboard_record_t record = { { 'A' + (seed >> 8) % 26, 'A' + (seed >> 16) % 26 }, ((seed >> 4) % 500) * 40, 0, i } ;
+        int expected = leaderboard_get_rank(&board, record.score) ;
+        int rank = leaderboard_add(&board, &record) ;
+        assert(rank == expected || (rank == 0 && expected > LEADERBOARD_MAX_ENTRIES)) ;
+        if ((i + 1) % 2048 == 0) {
+            printf("%d entries: %d ns per add\n", leaderboard_get_count(&board), (int)((timer_get_ticks() - start) * 1000 / TICKS_PER_USEC / 2048)) ;
+            start = timer_get_ticks() ;
+        }
+    }
+    assert(leaderboard_get_count(&board) == LEADERBOARD_MAX_ENTRIES) ;
+
+    // pages come out in rank order, and every player's best is their highest entry
+    leaderboard_record_t page[10] ;
+    unsigned int last = 0xFFFFFFFF ;
+    for (int rank = 1; rank <= LEADERBOARD_MAX_ENTRIES; rank += 10) {
+        int n = leaderboard_get_page(&board, rank, page, 10) ;
+        assert(n == 10 || rank + n - 1 == LEADERBOARD_MAX_ENTRIES) ;
+        for (int i = 0; i < n; i++) {
+            assert(page[i].score <= last) ;
+            last = page[i].score ;
+            leaderboard_record_t best ; int best_rank = 0 ;
+            assert(leaderboard_get_best(&board, page[i].initials, &best, &best_rank)) ;
+            assert(best_rank <= rank + i && best.score >= page[i].score) ;
+        }
+    }
+    printf("leaderboard ranks: ok\n") ;
+}
+
+void test_bevel_frames(void) { // render_frame's spans (make BEVEL_SPANS=1) against libmango's gl_draw_line, which draws the square bevels without them
+    uart_init() ;
+    if (!BEVEL_SPANS) {
+        printf("bevel frames: render_frame draws with gl_draw_line in this build; make BEVEL_SPANS=1 to check its spans\n") ;
+        return ;
+    }
+    int width = 10 * 20 ; int height = 20 * 20 ; // the game's board of 20-pixel squares
+    render_init(width, height, RENDER_ARGB8888) ;
+    color_t* draw = render_get_draw_buffer() ;
+    static color_t lines[10 * 20 * 20 * 20] ;
+
+    // every square's bevel the old way: four lines
+    gl_clear(GL_BLACK) ;
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 10; x++) {
+            color_t color = game_update_cell_color(1 + (x + y) % 7) ;
+            int left = x * 20 + 1 ; int top = y * 20 + 1 ; int right = x * 20 + 18 ; int bottom = y * 20 + 18 ;
+            gl_draw_line(left, top, right, top, color) ;
+            gl_draw_line(left, top, left, bottom, color) ;
+            gl_draw_line(right, bottom, right, top, color) ;
+            gl_draw_line(right, bottom, left, bottom, color) ;
+        }
+    }
+    for (int i = 0; i < width * height; i++) lines[i] = draw[i] ;
+
+    // and the new way
+    gl_clear(GL_BLACK) ;
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 10; x++) render_frame(x * 20 + 1, y * 20 + 1, 18, 18, game_update_cell_color(1 + (x + y) % 7)) ;
+    }
+    int mismatches = 0 ;
+    for (int i = 0; i < width * height; i++) {
+        if (draw[i] == lines[i]) continue ;
+        if (mismatches < 10) printf("(%d, %d): lines %08x, render_frame %08x\n", i % width, i / width, lines[i], draw[i]) ;
+        mismatches++ ;
+    }
+    printf("bevel frames: %d pixels differ from gl_draw_line's\n", mismatches) ;
+    assert(mismatches == 0) ;
+}
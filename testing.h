@@ -3,6 +3,7 @@
 
 // void pause(const char *message);
 void test_random_init(void);
+void test_random_seed(void);
 void test_basic_block_motion(void);
 void test_motions(void);
 int get_keystroke(const char *message);
@@ -19,4 +20,12 @@ void integration_test_v6(void) ; // testing with tuck, polishing game loop
 void integration_test_v8(void) ; // tetris theme intrp with blinking screen
 void integration_test_v9(void) ; // tetris theme intrp with game
 void integration_test_v10(void) ; // with speedup dropping blocks
+void test_song_uart(void) ; // songs sent from the host over uart
+void test_sound_effects(void) ; // sound effects over the tetris theme
+void test_replay_last_game(void) ; // replays the input log of the last game (headless) and checks the score
+void test_autoplay(void) ; // the autoplayer plays on the Mango Pi within a per-frame time budget
+void test_pixel_kernels(void) ; // vector pixel kernels against the scalar ones, then their speed
+void test_leaderboard_log(void) ; // the leaderboard log on storage: fill, reopen, compact, a broken record
+void test_leaderboard_ranks(void) ; // the all-time leaderboard: ranks, pages and best entries of a full board
+void test_bevel_frames(void) ; // render_frame's spans (BEVEL_SPANS) against libmango's gl_draw_line (run on the board)
 #endif
\ No newline at end of file
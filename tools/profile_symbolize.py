@@ -0,0 +1,86 @@
+#!/usr/bin/env python3
+"""
+profile_symbolize.py
+Turns the histogram printed by profiler_dump (profiler.c) into a flat profile by function
+Author: Aditi (aditijb@stanford.edu)
+
+Usage:
+    profile_symbolize.py dump.txt myprogram.elf [--nm riscv64-unknown-elf-nm] [--top N]
+
+dump.txt is the uart output saved from the Mango Pi (e.g. `mango-run myprogram.bin | tee dump.txt`);
+anything outside the PROFILE ... END block is ignored, and if there are several blocks the last
+one is used. Each bucket is charged to the function containing the bucket's first address.
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+
+def read_dump(path):
+    header, buckets = None, []
+    inside = False
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            if line.startswith("PROFILE"):
+                header = dict(kv.split("=", 1) for kv in line.split()[1:])
+                buckets = []
+                inside = True
+            elif line == "END":
+                inside = False
+            elif inside:
+                m = re.match(r"(0x[0-9a-fA-F]+)\s+(\d+)$", line)
+                if m:
+                    buckets.append((int(m.group(1), 16), int(m.group(2))))
+    if header is None:
+        sys.exit("%s: no PROFILE block found" % path)
+    return header, buckets
+
+
+def read_symbols(elf, nm):
+    try:
+        out = subprocess.run([nm, "-n", "--defined-only", elf], check=True,
+                             capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("could not run %s on %s: %s" % (nm, elf, e))
+    addrs, names = [], []
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[1] in "tTwW":
+            addrs.append(int(parts[0], 16))
+            names.append(parts[2])
+    return addrs, names
+
+
+def main():
+    parser = argparse.ArgumentParser(description="symbolize a profiler_dump histogram")
+    parser.add_argument("dump")
+    parser.add_argument("elf")
+    parser.add_argument("--nm", default="riscv64-unknown-elf-nm")
+    parser.add_argument("--top", type=int, default=30, help="number of functions to show")
+    args = parser.parse_args()
+
+    header, buckets = read_dump(args.dump)
+    addrs, names = read_symbols(args.elf, args.nm)
+
+    per_function = {}
+    for addr, count in buckets:
+        i = bisect.bisect_right(addrs, addr) - 1
+        name = names[i] if i >= 0 else "??"
+        per_function[name] = per_function.get(name, 0) + count
+
+    samples = int(header.get("samples", 0)) or sum(per_function.values()) or 1
+    rate = int(header.get("rate", 0))
+    print("%d samples%s, %s outside the histogram" % (
+        samples, " (%.1f s)" % (samples / rate) if rate else "", header.get("outside", "0")))
+    print("%8s %7s  %s" % ("samples", "%", "function"))
+    ranked = sorted(per_function.items(), key=lambda kv: kv[1], reverse=True)
+    for name, count in ranked[:args.top]:
+        print("%8d %6.2f%%  %s" % (count, 100.0 * count / samples, name))
+
+
+if __name__ == "__main__":
+    main()
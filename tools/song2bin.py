@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""
+song2bin.py
+Converts text scores (songs/*.txt) into the packed binary song format read by song.c
+Author: Aditi (aditijb@stanford.edu)
+
+Score syntax (one note per pair of tokens, a token starting with '#' begins a comment):
+    tempo 140       tempo in beats per minute (default 60)
+    loop            the song loops back to here once it reaches the end (or `endloop`)
+    endloop         optional end of the looped section
+    E4 q            note letter, optional #/b, octave (default 4), then a length:
+    r h             w = whole, h = half, q = quarter, e = eighth, a trailing '.' makes it
+                    dotted (q. = quarter + eighth), or a plain number of eighth notes
+
+Usage:
+    song2bin.py score.txt -o song.bin           binary song file (e.g. to send over uart)
+    song2bin.py --c-source song_assets a.txt b.txt
+                                                song_assets.c/.h with one linked-in blob per
+                                                score, named song_<score file name>
+"""
+
+import argparse
+import os
+import struct
+import sys
+
+MAGIC = b"TSNG"
+VERSION = 1
+FLAG_LOOP = 0x1
+
+LENGTHS = {"w": 8, "h": 4, "q": 2, "e": 1}
+SEMITONES = {"C": 0, "D": 2, "E": 4, "F": 5, "G": 7, "A": 9, "B": 11}
+
+
+class ScoreError(Exception):
+    pass
+
+
+def parse_pitch(token):
+    if token.lower() == "r":
+        return 0
+    letter = token[0].upper()
+    if letter not in SEMITONES:
+        raise ScoreError("bad note '%s'" % token)
+    semitone = SEMITONES[letter]
+    rest = token[1:]
+    if rest.startswith("#"):
+        semitone += 1
+        rest = rest[1:]
+    elif rest.startswith("b"):
+        semitone -= 1
+        rest = rest[1:]
+    octave = int(rest) if rest else 4
+    midi = 12 * (octave + 1) + semitone
+    if not 1 <= midi <= 119:
+        raise ScoreError("note '%s' out of range" % token)
+    return midi
+
+
+def parse_length(token):
+    if token.isdigit():
+        eighths = int(token)
+    else:
+        dotted = token.endswith(".")
+        base = token.rstrip(".")
+        if base not in LENGTHS:
+            raise ScoreError("bad length '%s'" % token)
+        eighths = LENGTHS[base]
+        if dotted:
+            eighths += eighths // 2
+    if not 1 <= eighths <= 255:
+        raise ScoreError("length '%s' out of range" % token)
+    return eighths
+
+
+def parse_score(text):
+    tempo = 60
+    events = []
+    loop_start = None
+    loop_end = None
+    for lineno, line in enumerate(text.splitlines(), 1):
+        tokens = line.split()
+        for i, token in enumerate(tokens):
+            if token.startswith("#"):
+                tokens = tokens[:i]
+                break
+        try:
+            while tokens:
+                word = tokens.pop(0)
+                if word == "tempo":
+                    tempo = int(tokens.pop(0))
+                elif word == "loop":
+                    loop_start = len(events)
+                elif word == "endloop":
+                    loop_end = len(events)
+                else:
+                    if not tokens:
+                        raise ScoreError("note '%s' is missing a length" % word)
+                    events.append((parse_pitch(word), parse_length(tokens.pop(0))))
+        except (ScoreError, ValueError, IndexError) as e:
+            raise ScoreError("line %d: %s" % (lineno, e))
+    if not events:
+        raise ScoreError("score has no notes")
+    if len(events) > 0xFFFF:
+        raise ScoreError("score has too many notes")
+    flags = 0
+    if loop_start is not None:
+        flags |= FLAG_LOOP
+        if loop_end is None:
+            loop_end = len(events)
+        if loop_start >= loop_end:
+            raise ScoreError("empty loop section")
+    return tempo, flags, events, loop_start or 0, loop_end or len(events)
+
+
+def pack_song(tempo, flags, events, loop_start, loop_end):
+    header = MAGIC + struct.pack("<BBHHHH", VERSION, flags, tempo, len(events), loop_start, loop_end)
+    return header + b"".join(struct.pack("BB", pitch, length) for pitch, length in events)
+
+
+def c_name(path):
+    base = os.path.splitext(os.path.basename(path))[0]
+    return "song_" + "".join(ch if ch.isalnum() else "_" for ch in base)
+
+
+def write_c_source(basename, songs):
+    guard = os.path.basename(basename).upper() + "_H"
+    with open(basename + ".h", "w") as h:
+        h.write("/* %s.h\n * Generated by tools/song2bin.py from the scores in songs/ -- do not edit, run `make songs`\n */\n\n" % os.path.basename(basename))
+        h.write("#ifndef %s\n#define %s\n\n" % (guard, guard))
+        for name, _ in songs:
+            h.write("extern const unsigned char %s[] ;\n" % name)
+            h.write("extern const unsigned int %s_size ;\n" % name)
+        h.write("\n#endif\n")
+    with open(basename + ".c", "w") as c:
+        c.write("/* %s.c\n * Generated by tools/song2bin.py from the scores in songs/ -- do not edit, run `make songs`\n */\n\n" % os.path.basename(basename))
+        c.write('#include "%s.h"\n' % os.path.basename(basename))
+        for name, blob in songs:
+            c.write("\nconst unsigned char %s[] = {\n" % name)
+            for i in range(0, len(blob), 14):
+                c.write("    " + ", ".join("0x%02x" % b for b in blob[i:i + 14]) + ",\n")
+            c.write("} ;\n")
+            c.write("const unsigned int %s_size = sizeof(%s) ;\n" % (name, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="convert text scores to packed songs")
+    parser.add_argument("scores", nargs="+")
+    parser.add_argument("-o", "--output", help="binary output file (single score)")
+    parser.add_argument("--c-source", metavar="BASENAME", help="write BASENAME.c/.h with every score")
+    args = parser.parse_args()
+
+    songs = []
+    for path in args.scores:
+        with open(path) as f:
+            try:
+                songs.append((c_name(path), pack_song(*parse_score(f.read()))))
+            except ScoreError as e:
+                sys.exit("%s: %s" % (path, e))
+
+    if args.c_source:
+        write_c_source(args.c_source, songs)
+    elif args.output and len(songs) == 1:
+        with open(args.output, "wb") as f:
+            f.write(songs[0][1])
+    else:
+        sys.exit("need -o with a single score, or --c-source")
+
+
+if __name__ == "__main__":
+    main()